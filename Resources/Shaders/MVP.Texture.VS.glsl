@@ -6,8 +6,11 @@ layout(location = 2) in vec2 v_texture_coord;
 layout(location = 3) in vec3 v_color;
 
 uniform mat4 Model;
-uniform mat4 View;
-uniform mat4 Projection;
+layout(std140) uniform Camera
+{
+	mat4 View;
+	mat4 Projection;
+};
 
 out vec3 frag_normal;
 out vec3 frag_color;
@@ -3,8 +3,11 @@
 layout(location = 0) in vec3 v_position;
 
 uniform mat4 Model;
-uniform mat4 View;
-uniform mat4 Projection;
+layout(std140) uniform Camera
+{
+	mat4 View;
+	mat4 Projection;
+};
 
 void main()
 {
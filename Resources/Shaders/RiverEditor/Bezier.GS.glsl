@@ -1,24 +1,67 @@
 #version 430
-layout(lines) in;
+layout(lines_adjacency) in;
 layout(triangle_strip, max_vertices = 256) out;
 
-uniform mat4 View;
-uniform mat4 Projection;
+layout(std140) uniform Camera
+{
+	mat4 View;
+	mat4 Projection;
+};
 
-uniform vec3 control_points[4];
 uniform float surface_width;
 
 uniform int no_of_instances;
 uniform int generated_points_count;
 
+// Adaptive tessellation
+uniform int tessellation_mode;
+uniform float flatness_tolerance;
+uniform ivec2 screen_size;
+
 uniform float time;
 uniform float speed;
 uniform float tilingFactor;
 
-in int instance[2];
+in int instance[4];
+in float width[4];
+in int segment_id[4];
+in int texture_segment_id[4];
 
 layout(location = 0) out vec2 v_tex_coord;
 
+// Arc length table of the segments, written by River::UploadSegments
+layout(std430, binding = 3) readonly buffer arc_lengths {
+	vec4 arc_length_table[];
+};
+
+const int ARC_LENGTH_SAMPLES = 16;
+
+// Fraction of the segment length covered up to t, so the texture doesn't stretch where the curve speeds up
+float arc_length_fraction(int segment, float t)
+{
+	float x = clamp(t, 0, 1) * ARC_LENGTH_SAMPLES;
+	int i = min(int(x), ARC_LENGTH_SAMPLES - 1);
+	float s0 = i == 0 ? 0 : arc_length_table[4 * segment + (i - 1) / 4][(i - 1) % 4];
+	float s1 = arc_length_table[4 * segment + i / 4][i % 4];
+	return mix(s0, s1, x - i);
+}
+
+// Bezier points of the current segment
+vec3 control_points[4];
+
+// Width factor of the river, a cubic with its own Bezier points
+float width_at(float t)
+{
+	float s = 1 - t;
+	return s * s * s * width[0] + 3 * s * s * t * width[1] + 3 * s * t * t * width[2] + t * t * t * width[3];
+}
+
+// Bounded by max_vertices, each point emits 2 vertices
+const int MAX_POINTS = 128;
+
+const int TESSELLATION_UNIFORM = 0;
+const int TESSELLATION_ADAPTIVE = 1;
+
 vec3 translateX(vec3 point, float t)
 {
 	return vec3(point.x + t, point.y, point.z);
@@ -53,28 +96,60 @@ void emit_points(float t)
 	vec3 normal = get_curve_normal(t);
 
 	// Offset along the normal
-	vec3 offset = surface_width / 2.0f * normal;
+	vec3 offset = surface_width * width_at(t) / 2.0f * normal;
 
 	// Create one point on each side to build the surface
-	float tex_u = t * tilingFactor + speed * time;
+	float tex_u = (texture_segment_id[0] + arc_length_fraction(segment_id[0], t)) * tilingFactor + speed * time;
 	gl_Position = Projection* View * vec4(bezier(t) - offset, 1);	v_tex_coord = vec2(tex_u, 0);	EmitVertex();
 	gl_Position = Projection* View * vec4(bezier(t) + offset, 1);	v_tex_coord = vec2(tex_u, 1);	EmitVertex();
 }
 
+vec2 to_screen(vec3 point)
+{
+	vec4 clip = Projection * View * vec4(point, 1);
+	return (clip.xy / clip.w * 0.5f + 0.5f) * vec2(screen_size);
+}
+
+// Wang's formula: number of segments needed so that the polyline
+// stays within flatness_tolerance pixels from the curve
+int adaptive_points_count()
+{
+	vec2 p0 = to_screen(control_points[0]);
+	vec2 p1 = to_screen(control_points[1]);
+	vec2 p2 = to_screen(control_points[2]);
+	vec2 p3 = to_screen(control_points[3]);
+
+	float second_difference = max(length(p0 - 2 * p1 + p2), length(p1 - 2 * p2 + p3));
+
+	// d * (d - 1) / 8 for a cubic curve
+	float segments = ceil(sqrt(0.75f * second_difference / flatness_tolerance));
+	return int(segments) + 1;
+}
+
 void main()
 {
-	if (instance[0] < no_of_instances)
+	for (int i = 0; i < 4; i++)
 	{
-		// X points => X - 1 segments
-		float step = 1.0 / (generated_points_count - 1);
+		control_points[i] = gl_in[i].gl_Position.xyz;
+	}
 
-		for (float t = 0.0f; t < 1.0f; t += step)
+	// Negative instances are the empty slots of RiverNetwork.VS.glsl
+	if (instance[0] >= 0 && instance[0] < no_of_instances)
+	{
+		int points_count = generated_points_count;
+		if (tessellation_mode == TESSELLATION_ADAPTIVE)
 		{
-			emit_points(t);
+			points_count = adaptive_points_count();
 		}
+		points_count = clamp(points_count, 2, MAX_POINTS);
 
-		// Add the final point to the curve
-		emit_points(1.0f);
+		// X points => X - 1 segments
+		float step = 1.0 / (points_count - 1);
+
+		for (int i = 0; i < points_count; i++)
+		{
+			emit_points(i * step);
+		}
 
 		EndPrimitive();
 	}
@@ -0,0 +1,65 @@
+#version 430
+layout(vertices = 4) out;
+
+layout(std140) uniform Camera
+{
+	mat4 View;
+	mat4 Projection;
+};
+
+uniform int generated_points_count;
+
+// Screen space level of detail
+uniform int tessellation_mode;
+uniform float pixels_per_edge;
+uniform ivec2 screen_size;
+
+// Width factors of the patch, passed to the evaluation shader
+in float width[];
+out float patch_width[];
+
+const int TESSELLATION_UNIFORM = 0;
+const int TESSELLATION_ADAPTIVE = 1;
+
+vec2 to_screen(vec3 point)
+{
+	vec4 clip = Projection * View * vec4(point, 1);
+	return (clip.xy / clip.w * 0.5f + 0.5f) * vec2(screen_size);
+}
+
+// The control polygon is never shorter than the curve, so its length on screen is a safe estimate
+float screen_length()
+{
+	vec2 p0 = to_screen(gl_in[0].gl_Position.xyz);
+	vec2 p1 = to_screen(gl_in[1].gl_Position.xyz);
+	vec2 p2 = to_screen(gl_in[2].gl_Position.xyz);
+	vec2 p3 = to_screen(gl_in[3].gl_Position.xyz);
+
+	return length(p1 - p0) + length(p2 - p1) + length(p3 - p2);
+}
+
+void main()
+{
+	gl_out[gl_InvocationID].gl_Position = gl_in[gl_InvocationID].gl_Position;
+	patch_width[gl_InvocationID] = width[gl_InvocationID];
+
+	if (gl_InvocationID == 0)
+	{
+		float level = generated_points_count - 1;
+		if (tessellation_mode == TESSELLATION_ADAPTIVE)
+		{
+			level = ceil(screen_length() / pixels_per_edge);
+		}
+
+		// The hardware clamps the level to GL_MAX_TESS_GEN_LEVEL
+		level = max(level, 1.0f);
+
+		// u goes along the curve, v across the river
+		gl_TessLevelOuter[0] = 1;
+		gl_TessLevelOuter[1] = level;
+		gl_TessLevelOuter[2] = 1;
+		gl_TessLevelOuter[3] = level;
+		gl_TessLevelInner[0] = level;
+		gl_TessLevelInner[1] = 1;
+	}
+}
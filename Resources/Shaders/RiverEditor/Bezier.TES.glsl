@@ -0,0 +1,81 @@
+#version 430
+layout(quads, equal_spacing, ccw) in;
+
+layout(std140) uniform Camera
+{
+	mat4 View;
+	mat4 Projection;
+};
+
+uniform float surface_width;
+
+uniform float time;
+uniform float speed;
+uniform float tilingFactor;
+
+in float patch_width[];
+
+layout(location = 0) out vec2 v_tex_coord;
+
+// Normalized arc lengths, ARC_LENGTH_SAMPLES for each segment
+layout(std430, binding = 3) readonly buffer arc_lengths {
+	vec4 arc_length_table[];
+};
+
+const int ARC_LENGTH_SAMPLES = 16;
+
+// Same lookup as Bezier.GS.glsl
+float arc_length_fraction(int segment, float t)
+{
+	float x = clamp(t, 0, 1) * ARC_LENGTH_SAMPLES;
+	int i = min(int(x), ARC_LENGTH_SAMPLES - 1);
+	float s0 = i == 0 ? 0 : arc_length_table[4 * segment + (i - 1) / 4][(i - 1) % 4];
+	float s1 = arc_length_table[4 * segment + i / 4][i % 4];
+	return mix(s0, s1, x - i);
+}
+
+vec3 control_points[4];
+
+vec3 bezier(float t)
+{
+	float s = 1 - t;
+	return s * s * s * control_points[0] + 3 * s * s * t * control_points[1] +
+			3 * s * t * t * control_points[2] + t * t * t * control_points[3];
+}
+
+// Same width profile as Bezier.GS.glsl
+float width_at(float t)
+{
+	float s = 1 - t;
+	return s * s * s * patch_width[0] + 3 * s * s * t * patch_width[1] +
+			3 * s * t * t * patch_width[2] + t * t * t * patch_width[3];
+}
+
+vec3 get_curve_normal(float t)
+{
+	float s = 1 - t;
+	vec3 tangent = 3 * s * s * (control_points[1] - control_points[0]) +
+					6 * s * t * (control_points[2] - control_points[1]) +
+					3 * t * t * (control_points[3] - control_points[2]);
+
+	// Return a normal in the same plane
+	return normalize(vec3(tangent.y, -tangent.x, 0));
+}
+
+void main()
+{
+	for (int i = 0; i < 4; i++)
+	{
+		control_points[i] = gl_in[i].gl_Position.xyz;
+	}
+
+	float t = gl_TessCoord.x;
+	float side = gl_TessCoord.y;
+
+	// Same surface as Bezier.GS.glsl, v goes from one bank to the other
+	vec3 offset = surface_width * width_at(t) * (side - 0.5f) * get_curve_normal(t);
+
+	float tex_u = (gl_PrimitiveID + arc_length_fraction(gl_PrimitiveID, t)) * tilingFactor + speed * time;
+	v_tex_coord = vec2(tex_u, side);
+	gl_Position = Projection * View * vec4(bezier(t) + offset, 1);
+}
@@ -0,0 +1,32 @@
+#version 410
+
+layout(location = 0) in vec2 texture_coord;
+
+uniform sampler2D u_texture_0;
+
+// Texel of the source, twice the size of the target
+uniform vec2 texel_size;
+
+// Brightness below which the source is left out, 0 keeps everything
+uniform float threshold;
+
+layout(location = 0) out vec4 out_color;
+
+vec3 bright(vec2 coord)
+{
+	vec3 color = texture(u_texture_0, coord).rgb;
+	float brightness = dot(color, vec3(0.2126, 0.7152, 0.0722));
+	return brightness >= threshold ? color : vec3(0);
+}
+
+void main()
+{
+	// Dual filter downsample, each bilinear tap averages 2x2 texels, together they cover 4x4
+	vec3 sum = bright(texture_coord) * 4.0f;
+	sum += bright(texture_coord + vec2(-1, -1) * texel_size);
+	sum += bright(texture_coord + vec2( 1, -1) * texel_size);
+	sum += bright(texture_coord + vec2(-1,  1) * texel_size);
+	sum += bright(texture_coord + vec2( 1,  1) * texel_size);
+
+	out_color = vec4(sum / 8.0f, 1.0f);
+}
@@ -0,0 +1,26 @@
+#version 410
+
+layout(location = 0) in vec2 texture_coord;
+
+uniform sampler2D u_texture_0;
+
+// Texel of the source, half the size of the target
+uniform vec2 texel_size;
+
+layout(location = 0) out vec4 out_color;
+
+void main()
+{
+	// Dual filter upsample, a tent over the 8 bilinear taps around the texel
+	vec3 sum = vec3(0);
+	sum += texture(u_texture_0, texture_coord + vec2(-1,  0) * texel_size).rgb;
+	sum += texture(u_texture_0, texture_coord + vec2( 1,  0) * texel_size).rgb;
+	sum += texture(u_texture_0, texture_coord + vec2( 0, -1) * texel_size).rgb;
+	sum += texture(u_texture_0, texture_coord + vec2( 0,  1) * texel_size).rgb;
+	sum += texture(u_texture_0, texture_coord + vec2(-0.5, -0.5) * texel_size).rgb * 2.0f;
+	sum += texture(u_texture_0, texture_coord + vec2( 0.5, -0.5) * texel_size).rgb * 2.0f;
+	sum += texture(u_texture_0, texture_coord + vec2(-0.5,  0.5) * texel_size).rgb * 2.0f;
+	sum += texture(u_texture_0, texture_coord + vec2( 0.5,  0.5) * texel_size).rgb * 2.0f;
+
+	out_color = vec4(sum / 12.0f, 1.0f);
+}
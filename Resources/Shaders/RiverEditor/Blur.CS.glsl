@@ -0,0 +1,78 @@
+#version 430
+
+// Box blur of the image lines. Each work group reads a tile of a line and an apron of radius texels
+// on both sides into shared memory once, as prefix sums, so the cost doesn't grow with the radius.
+#define TILE_SIZE 256
+#define MAX_RADIUS 128
+#define SPAN (TILE_SIZE + 2 * MAX_RADIUS)
+#define CHUNK_SIZE (SPAN / TILE_SIZE)
+
+layout(local_size_x = TILE_SIZE) in;
+
+uniform sampler2D u_texture_0;
+layout(rgba16f, binding = 0) writeonly uniform image2D target;
+
+// Box of 2 * radius + 1 texels, at most MAX_RADIUS
+uniform int radius;
+
+// (1, 0) blurs the rows, (0, 1) the columns
+uniform ivec2 direction;
+
+// Sum of the texels of the span before each index, sums[0] is 0
+shared vec4 sums[SPAN + 1];
+shared vec4 chunk_sums[TILE_SIZE];
+
+void main()
+{
+	ivec2 size = textureSize(u_texture_0, 0);
+	int line_length = direction.x == 1 ? size.x : size.y;
+	int line = int(gl_WorkGroupID.y);
+	int tile_start = int(gl_WorkGroupID.x) * TILE_SIZE;
+	int index = int(gl_LocalInvocationID.x);
+	int span = TILE_SIZE + 2 * radius;
+
+	// Every texel of the tile and its apron is read once, in chunks, clamped to the image edges
+	vec4 sum = vec4(0);
+	for (int i = 0; i < CHUNK_SIZE; i++)
+	{
+		int k = index * CHUNK_SIZE + i;
+		if (k < span)
+		{
+			int along = clamp(tile_start - radius + k, 0, line_length - 1);
+			sum += texelFetch(u_texture_0, direction * along + direction.yx * line, 0);
+		}
+		sums[k + 1] = sum;
+	}
+	chunk_sums[index] = sum;
+	barrier();
+
+	// Inclusive scan of the chunk sums
+	for (int offset = 1; offset < TILE_SIZE; offset *= 2)
+	{
+		vec4 previous = index >= offset ? chunk_sums[index - offset] : vec4(0);
+		barrier();
+		chunk_sums[index] += previous;
+		barrier();
+	}
+
+	// The chunks only summed their own texels so far
+	if (index > 0)
+	{
+		vec4 before = chunk_sums[index - 1];
+		for (int i = 0; i < CHUNK_SIZE; i++)
+			sums[index * CHUNK_SIZE + i + 1] += before;
+	}
+	else
+	{
+		sums[0] = vec4(0);
+	}
+	barrier();
+
+	int along = tile_start + index;
+	if (along >= line_length)
+		return;
+
+	// Sliding window, two reads whatever the radius
+	vec4 window = sums[index + 2 * radius + 1] - sums[index];
+	imageStore(target, direction * along + direction.yx * line, window / float(2 * radius + 1));
+}
@@ -0,0 +1,25 @@
+#version 430
+
+layout(location = 0) in vec3 v_position;
+layout(location = 2) in vec2 v_texture_coord;
+
+// Per instance, center and size of the gizmo
+layout(location = 3) in vec4 i_position_scale;
+layout(location = 4) in float i_selected;
+
+layout(std140) uniform Camera
+{
+	mat4 View;
+	mat4 Projection;
+};
+
+layout(location = 0) out vec2 texture_coord;
+
+void main()
+{
+	// The selected gizmo is drawn larger
+	float scale = i_position_scale.w * (i_selected > 0.5 ? 1.5 : 1.0);
+
+	texture_coord = v_texture_coord;
+	gl_Position = Projection * View * vec4(i_position_scale.xyz + v_position * scale, 1);
+}
@@ -0,0 +1,28 @@
+#version 430
+layout(local_size_x = 16, local_size_y = 16) in;
+
+uniform sampler2D u_texture_0;
+layout(rgba16f, binding = 0) writeonly uniform image2D target;
+
+// Distance of the taps in texels, grows with every pass
+uniform float offset;
+
+void main()
+{
+	ivec2 size = textureSize(u_texture_0, 0);
+	ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+	if (any(greaterThanEqual(texel, size)))
+		return;
+
+	vec2 texel_size = 1.0f / vec2(size);
+	vec2 coord = (vec2(texel) + 0.5f) * texel_size;
+	vec2 d = (offset + 0.5f) * texel_size;
+
+	// Four bilinear taps on the diagonals, each one averages 2x2 texels
+	vec4 sum = textureLod(u_texture_0, coord + vec2(-d.x, -d.y), 0);
+	sum += textureLod(u_texture_0, coord + vec2( d.x, -d.y), 0);
+	sum += textureLod(u_texture_0, coord + vec2(-d.x,  d.y), 0);
+	sum += textureLod(u_texture_0, coord + vec2( d.x,  d.y), 0);
+
+	imageStore(target, texel, sum / 4.0f);
+}
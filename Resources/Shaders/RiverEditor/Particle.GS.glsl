@@ -2,8 +2,12 @@
 layout(points) in;
 layout(triangle_strip, max_vertices = 4) out;
 
-uniform mat4 View;
-uniform mat4 Projection;
+layout(std140) uniform Camera
+{
+	mat4 View;
+	mat4 Projection;
+};
+
 uniform vec3 eye_position;
 
 uniform float particle_size;
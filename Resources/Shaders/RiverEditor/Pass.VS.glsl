@@ -1,6 +1,7 @@
 #version 430
 
-layout(location = 0) in vec3 v_position;
+// Bezier point of the river, w is the width factor
+layout(location = 0) in vec4 v_position;
 layout(location = 1) in vec3 v_normal;
 layout(location = 2) in vec2 v_texture_coord;
 
@@ -8,11 +9,19 @@ layout(location = 2) in vec2 v_texture_coord;
 uniform mat4 Model;
 
 out int instance;
+out float width;
+
+// Index in the arc length table and along the river, the same for a single river
+out int segment_id;
+out int texture_segment_id;
 
 void main()
 {
 	instance = gl_InstanceID;
-	gl_Position =  Model * vec4(v_position, 1);
+	width = v_position.w;
+	segment_id = gl_VertexID / 4;
+	texture_segment_id = segment_id;
+	gl_Position =  Model * vec4(v_position.xyz, 1);
 }
 
 
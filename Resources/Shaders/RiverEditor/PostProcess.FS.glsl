@@ -0,0 +1,79 @@
+#version 410
+
+// Per pixel stages of the post processing graph fused in one pass, see PostProcessGraph
+#define STAGE_WAVE		0
+#define STAGE_BLOOM		1
+#define MAX_STAGES		8
+
+layout(location = 0) in vec2 texture_coord;
+
+// Image before the first stage
+uniform sampler2D u_texture_0;
+
+// Bright spots of that image blurred by the bloom chain
+uniform sampler2D u_texture_1;
+
+uniform int stages_count;
+uniform int stages[MAX_STAGES];
+
+uniform float time;
+uniform float frequency;
+uniform float bloom_intensity;
+
+// The image is smaller than the target, read with a Catmull-Rom filter instead of a bilinear one
+uniform int upscale;
+
+layout(location = 0) out vec4 out_color;
+
+// 5 bilinear taps, the corners of the 4x4 texels footprint are left out
+vec3 catmull_rom(sampler2D image, vec2 coord)
+{
+	vec2 size = vec2(textureSize(image, 0));
+	vec2 position = coord * size;
+	vec2 center = floor(position - 0.5f) + 0.5f;
+	vec2 f = position - center;
+
+	vec2 w0 = f * (-0.5f + f * (1.0f - 0.5f * f));
+	vec2 w1 = 1.0f + f * f * (-2.5f + 1.5f * f);
+	vec2 w2 = f * (0.5f + f * (2.0f - 1.5f * f));
+	vec2 w3 = f * f * (-0.5f + 0.5f * f);
+
+	// The middle texels are read together, the bilinear filter weights them
+	vec2 w12 = w1 + w2;
+	vec2 coord0 = (center - 1.0f) / size;
+	vec2 coord3 = (center + 2.0f) / size;
+	vec2 coord12 = (center + w2 / w12) / size;
+
+	vec3 color = texture(image, vec2(coord12.x, coord0.y)).rgb * w12.x * w0.y;
+	color += texture(image, vec2(coord0.x, coord12.y)).rgb * w0.x * w12.y;
+	color += texture(image, coord12).rgb * w12.x * w12.y;
+	color += texture(image, vec2(coord3.x, coord12.y)).rgb * w3.x * w12.y;
+	color += texture(image, vec2(coord12.x, coord3.y)).rgb * w12.x * w3.y;
+
+	float weight = w12.x * w0.y + w0.x * w12.y + w12.x * w12.y + w3.x * w12.y + w12.x * w3.y;
+	return max(color / weight, vec3(0));
+}
+
+void main()
+{
+	// A wave moves where the stages before it are read, so the coordinates are found backwards
+	vec2 coords[MAX_STAGES + 1];
+	coords[stages_count] = texture_coord;
+	for (int i = stages_count - 1; i >= 0; i--)
+	{
+		vec2 coord = coords[i + 1];
+		if (stages[i] == STAGE_WAVE)
+			coord.x += sin(coord.y * frequency * 3.14 + time) / 100;
+		coords[i] = coord;
+	}
+
+	// Then the colors forwards, each stage at its own coordinates
+	vec3 color = upscale == 1 ? catmull_rom(u_texture_0, coords[0]) : texture(u_texture_0, coords[0]).rgb;
+	for (int i = 0; i < stages_count; i++)
+	{
+		if (stages[i] == STAGE_BLOOM)
+			color += texture(u_texture_1, coords[i]).rgb * bloom_intensity;
+	}
+
+	out_color = vec4(color, 1.0f);
+}
@@ -0,0 +1,22 @@
+#version 430
+
+layout(location = 0) in vec3 v_position;
+layout(location = 1) in vec3 v_normal;
+layout(location = 2) in vec2 v_texture_coord;
+
+// Model matrix of the draw, selected by the base instance of the indirect command
+layout(location = 4) in mat4 v_model;
+
+layout(std140) uniform Camera
+{
+	mat4 View;
+	mat4 Projection;
+};
+
+layout(location = 0) out vec2 texture_coord;
+
+void main()
+{
+	texture_coord = v_texture_coord;
+	gl_Position = Projection * View * v_model * vec4(v_position, 1);
+}
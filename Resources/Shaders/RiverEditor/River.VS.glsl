@@ -0,0 +1,22 @@
+#version 430
+
+layout(location = 0) in vec3 v_position;
+layout(location = 2) in vec2 v_texture_coord;
+
+// Uniform properties
+layout(std140) uniform Camera
+{
+	mat4 View;
+	mat4 Projection;
+};
+
+// River flow
+uniform float flow_offset;
+
+layout(location = 0) out vec2 texture_coord;
+
+void main()
+{
+	texture_coord = vec2(v_texture_coord.x + flow_offset, v_texture_coord.y);
+	gl_Position = Projection * View * vec4(v_position, 1);
+}
@@ -0,0 +1,42 @@
+#version 430
+
+// Bezier points of every river, 4 consecutive points for each segment, w is the width factor
+layout(std430, binding = 1) readonly buffer segments {
+	vec4 segment_points[];
+};
+
+// First segment and segments count of each river, written by RiverNetworkBuffer
+layout(std430, binding = 4) readonly buffer rivers {
+	ivec4 river_ranges[];
+};
+
+// Same outputs as Pass.VS.glsl, one instance for each river
+out int instance;
+out float width;
+out int segment_id;
+out int texture_segment_id;
+
+void main()
+{
+	ivec4 range = river_ranges[gl_InstanceID];
+	int segment = gl_VertexID / 4;
+
+	// Shorter rivers leave empty slots, the geometry shader skips them
+	if (segment >= range.y)
+	{
+		instance = -1;
+		width = 0;
+		segment_id = 0;
+		texture_segment_id = 0;
+		gl_Position = vec4(0, 0, 0, 1);
+		return;
+	}
+
+	vec4 point = segment_points[4 * (range.x + segment) + gl_VertexID % 4];
+
+	instance = 0;
+	width = point.w;
+	segment_id = range.x + segment;
+	texture_segment_id = segment;
+	gl_Position = vec4(point.xyz, 1);
+}
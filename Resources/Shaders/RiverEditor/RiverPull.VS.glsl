@@ -0,0 +1,33 @@
+#version 430
+
+struct RiverVertex
+{
+	vec4 position;
+	vec4 tex_coord;
+};
+
+// Written by RiverTessellation.CS.glsl
+layout(std430, binding = 2) readonly buffer vertices {
+	RiverVertex river_vertices[];
+};
+
+// Uniform properties
+layout(std140) uniform Camera
+{
+	mat4 View;
+	mat4 Projection;
+};
+
+// River flow
+uniform float flow_offset;
+
+layout(location = 0) out vec2 texture_coord;
+
+void main()
+{
+	// The draw command of the segment starts at its slot, gl_VertexID includes it
+	RiverVertex vertex = river_vertices[gl_VertexID];
+
+	texture_coord = vec2(vertex.tex_coord.x + flow_offset, vertex.tex_coord.y);
+	gl_Position = Projection * View * vertex.position;
+}
@@ -0,0 +1,151 @@
+#version 430
+layout(local_size_x = 64) in;
+
+// Bezier points of the segments, 4 consecutive points for each one, w is the width factor
+layout(std430, binding = 1) readonly buffer segments {
+	vec4 segment_points[];
+};
+
+struct RiverVertex
+{
+	vec4 position;
+	vec4 tex_coord;
+};
+
+// Every segment owns a slot of 2 * points_per_segment vertices
+layout(std430, binding = 2) writeonly buffer vertices {
+	RiverVertex river_vertices[];
+};
+
+// glDrawArraysIndirect command of each segment, it draws only the generated points
+struct DrawCommand
+{
+	uint count;
+	uint instance_count;
+	uint first;
+	uint base_instance;
+};
+
+layout(std430, binding = 5) writeonly buffer commands {
+	DrawCommand draw_commands[];
+};
+
+// Normalized arc lengths, ARC_LENGTH_SAMPLES for each segment
+layout(std430, binding = 3) readonly buffer arc_lengths {
+	vec4 arc_length_table[];
+};
+
+const int ARC_LENGTH_SAMPLES = 16;
+
+// Same lookup as Bezier.GS.glsl
+float arc_length_fraction(int segment, float t)
+{
+	float x = clamp(t, 0, 1) * ARC_LENGTH_SAMPLES;
+	int i = min(int(x), ARC_LENGTH_SAMPLES - 1);
+	float s0 = i == 0 ? 0 : arc_length_table[4 * segment + (i - 1) / 4][(i - 1) % 4];
+	float s1 = arc_length_table[4 * segment + i / 4][i % 4];
+	return mix(s0, s1, x - i);
+}
+
+// Range of segments to tessellate
+uniform int first_segment;
+uniform int segments_count;
+
+// Size of the slots, also the number of points in uniform mode
+uniform int points_per_segment;
+
+uniform float surface_width;
+uniform float tilingFactor;
+
+// Adaptive tessellation, same as Bezier.GS.glsl
+uniform int tessellation_mode;
+uniform float flatness_tolerance;
+uniform mat4 world_to_screen;
+
+const int TESSELLATION_UNIFORM = 0;
+const int TESSELLATION_ADAPTIVE = 1;
+
+vec3 control_points[4];
+float control_widths[4];
+
+// Width factor of the river, see Bezier.GS.glsl
+float width_at(float t)
+{
+	float s = 1 - t;
+	return s * s * s * control_widths[0] + 3 * s * s * t * control_widths[1] +
+			3 * s * t * t * control_widths[2] + t * t * t * control_widths[3];
+}
+
+vec3 bezier(float t)
+{
+	float s = 1 - t;
+	return s * s * s * control_points[0] + 3 * s * s * t * control_points[1] +
+			3 * s * t * t * control_points[2] + t * t * t * control_points[3];
+}
+
+vec3 get_curve_normal(float t)
+{
+	float s = 1 - t;
+	vec3 tangent = 3 * s * s * (control_points[1] - control_points[0]) +
+					6 * s * t * (control_points[2] - control_points[1]) +
+					3 * t * t * (control_points[3] - control_points[2]);
+
+	// Return a normal in the same plane
+	return normalize(vec3(tangent.y, -tangent.x, 0));
+}
+
+// Wang's formula, see Bezier.GS.glsl
+int adaptive_points_count()
+{
+	vec2 p0 = (world_to_screen * vec4(control_points[0], 1)).xy;
+	vec2 p1 = (world_to_screen * vec4(control_points[1], 1)).xy;
+	vec2 p2 = (world_to_screen * vec4(control_points[2], 1)).xy;
+	vec2 p3 = (world_to_screen * vec4(control_points[3], 1)).xy;
+
+	float second_difference = max(length(p0 - 2 * p1 + p2), length(p1 - 2 * p2 + p3));
+	return int(ceil(sqrt(0.75f * second_difference / flatness_tolerance))) + 1;
+}
+
+void main()
+{
+	// One invocation for each point, it writes the vertices on both sides of the curve
+	int id = int(gl_GlobalInvocationID.x);
+	if (id >= segments_count * points_per_segment)
+		return;
+
+	int segment = first_segment + id / points_per_segment;
+	int point = id % points_per_segment;
+
+	for (int i = 0; i < 4; i++)
+	{
+		control_points[i] = segment_points[4 * segment + i].xyz;
+		control_widths[i] = segment_points[4 * segment + i].w;
+	}
+
+	int points_count = points_per_segment;
+	if (tessellation_mode == TESSELLATION_ADAPTIVE)
+	{
+		points_count = clamp(adaptive_points_count(), 2, points_per_segment);
+	}
+
+	int vertex = 2 * (segment * points_per_segment + point);
+	if (point == 0)
+	{
+		draw_commands[segment] = DrawCommand(uint(2 * points_count), 1u, uint(vertex), 0u);
+	}
+
+	// The rest of the slot isn't drawn
+	if (point >= points_count)
+		return;
+
+	float t = point / float(points_count - 1);
+
+	vec3 position = bezier(t);
+	vec3 offset = surface_width * width_at(t) / 2.0f * get_curve_normal(t);
+	float tex_u = (segment + arc_length_fraction(segment, t)) * tilingFactor;
+
+	river_vertices[vertex].position = vec4(position - offset, 1);
+	river_vertices[vertex].tex_coord = vec4(tex_u, 0, 0, 0);
+	river_vertices[vertex + 1].position = vec4(position + offset, 1);
+	river_vertices[vertex + 1].tex_coord = vec4(tex_u, 1, 0, 0);
+}
@@ -0,0 +1,13 @@
+#version 410
+
+layout(location = 0) in vec3 v_position;
+layout(location = 2) in vec2 v_texture_coord;
+
+layout(location = 0) out vec2 texture_coord;
+
+void main()
+{
+	// The [-0.5, 0.5] quad stretched over the whole target, no camera needed
+	texture_coord = v_texture_coord;
+	gl_Position = vec4(v_position.xy * 2.0f, 0.0f, 1.0f);
+}
@@ -6,8 +6,11 @@ layout(location = 2) in vec2 v_texture_coord;
 
 // Uniform properties
 uniform mat4 Model;
-uniform mat4 View;
-uniform mat4 Projection;
+layout(std140) uniform Camera
+{
+	mat4 View;
+	mat4 Projection;
+};
 
 layout(location = 0) out vec2 texture_coord;
 
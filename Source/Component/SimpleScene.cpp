@@ -7,6 +7,8 @@
 #include "SceneInput.h"
 
 #include <Core/Engine.h>
+#include <Core/GPU/CameraUniforms.h>
+#include <Core/GPU/RenderState.h>
 #include <Component/Transform/Transform.h>
 
 using namespace std;
@@ -96,7 +98,8 @@ void SimpleScene::InitResources()
 
 	// Default rendering mode will use depth buffer
 	glDepthMask(GL_TRUE);
-	glEnable(GL_DEPTH_TEST);
+	RenderState::Invalidate();
+	RenderState::SetDepthTest(true);
 }
 
 void SimpleScene::AddMeshToList(Mesh * mesh)
@@ -121,6 +124,8 @@ void SimpleScene::DrawCoordinatSystem(const glm::mat4 & viewMatrix, const glm::m
 	{
 		Shader *shader = shaders["Color"];
 		shader->Use();
+		// Shaders declaring the Camera block ignore the plain View & Projection uniforms
+		CameraUniforms::Set(viewMatrix, projectionMaxtix);
 		glUniformMatrix4fv(shader->loc_view_matrix, 1, GL_FALSE, glm::value_ptr(viewMatrix));
 		glUniformMatrix4fv(shader->loc_projection_matrix, 1, GL_FALSE, glm::value_ptr(projectionMaxtix));
 
@@ -165,6 +170,7 @@ void SimpleScene::RenderMesh(Mesh * mesh, Shader * shader, glm::vec3 position, g
 
 	// render an object using the specified shader and the specified position
 	shader->Use();
+	CameraUniforms::Set(camera);
 	glUniformMatrix4fv(shader->loc_view_matrix, 1, GL_FALSE, glm::value_ptr(camera->GetViewMatrix()));
 	glUniformMatrix4fv(shader->loc_projection_matrix, 1, GL_FALSE, glm::value_ptr(camera->GetProjectionMatrix()));
 
@@ -186,6 +192,7 @@ void SimpleScene::RenderMesh2D(Mesh * mesh, Shader * shader, const glm::mat3 &mo
 		return;
 
 	shader->Use();
+	CameraUniforms::Set(camera);
 	glUniformMatrix4fv(shader->loc_view_matrix, 1, GL_FALSE, glm::value_ptr(camera->GetViewMatrix()));
 	glUniformMatrix4fv(shader->loc_projection_matrix, 1, GL_FALSE, glm::value_ptr(camera->GetProjectionMatrix()));
 	
@@ -216,6 +223,7 @@ void SimpleScene::RenderMesh2D(Mesh * mesh, const glm::mat3 & modelMatrix, const
 
 	// render an object using the specified shader and the specified position
 	shader->Use();
+	CameraUniforms::Set(camera);
 	glUniformMatrix4fv(shader->loc_view_matrix, 1, GL_FALSE, glm::value_ptr(camera->GetViewMatrix()));
 	glUniformMatrix4fv(shader->loc_projection_matrix, 1, GL_FALSE, glm::value_ptr(camera->GetProjectionMatrix()));
 	glUniformMatrix4fv(shader->loc_model_matrix, 1, GL_FALSE, glm::value_ptr(model));
@@ -231,6 +239,7 @@ void SimpleScene::RenderMesh(Mesh * mesh, Shader * shader, const glm::mat4 & mod
 
 	// render an object using the specified shader and the specified position
 	shader->Use();
+	CameraUniforms::Set(camera);
 	glUniformMatrix4fv(shader->loc_view_matrix, 1, GL_FALSE, glm::value_ptr(camera->GetViewMatrix()));
 	glUniformMatrix4fv(shader->loc_projection_matrix, 1, GL_FALSE, glm::value_ptr(camera->GetProjectionMatrix()));
 	glUniformMatrix4fv(shader->loc_model_matrix, 1, GL_FALSE, glm::value_ptr(modelMatrix));
@@ -282,3 +291,12 @@ bool SimpleScene::ToggleGroundPlane()
 	return drawGroundPlane;
 }
 
+void SimpleScene::SubmitMesh(Mesh * mesh, Shader * shader, const glm::mat4 & modelMatrix, Texture2D * texture, RenderPass pass)
+{
+	renderQueue.Submit(mesh, shader, texture, modelMatrix, pass);
+}
+
+void SimpleScene::FlushRenderQueue()
+{
+	renderQueue.Flush(camera);
+}
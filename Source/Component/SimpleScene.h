@@ -34,6 +34,11 @@ class SimpleScene : public World
 
 		virtual void RenderMesh(Mesh * mesh, Shader * shader, const glm::mat4 &modelMatrix);
 
+		// Deferred rendering, the submitted meshes are sorted and batched by FlushRenderQueue()
+		void SubmitMesh(Mesh * mesh, Shader * shader, const glm::mat4 &modelMatrix, Texture2D *texture = nullptr,
+						RenderPass pass = RENDER_PASS_OPAQUE);
+		void FlushRenderQueue();
+
 		virtual EngineComponents::Camera* GetSceneCamera() const final;
 		virtual InputController* GetCameraInput() const final;
 
@@ -45,6 +50,7 @@ class SimpleScene : public World
 	protected:
 		std::unordered_map<std::string, Mesh*> meshes;
 		std::unordered_map<std::string, Shader*> shaders;
+		RenderQueue renderQueue;
 
 	private:
 		EngineComponents::Camera *camera;
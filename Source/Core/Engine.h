@@ -16,6 +16,9 @@
 #include <Core/GPU/Texture2D.h>
 #include <Core/GPU/SSBO.h>
 #include <Core/GPU/ParticleEffect.h>
+#include <Core/GPU/RenderState.h>
+#include <Core/GPU/RenderQueue.h>
+#include <Core/GPU/GPUProfiler.h>
 
 #include <Core/World.h>
 
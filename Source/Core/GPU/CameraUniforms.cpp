@@ -0,0 +1,50 @@
+#include "CameraUniforms.h"
+
+#include <cstring>
+
+#include <include/utils.h>
+#include <Component/Camera/Camera.h>
+#include <Core/GPU/Shader.h>
+#include <Core/GPU/RenderState.h>
+
+GLuint CameraUniforms::buffer = 0;
+CameraUniforms::Block CameraUniforms::block;
+bool CameraUniforms::valid = false;
+
+void CameraUniforms::Set(const EngineComponents::Camera *camera)
+{
+	Set(camera->GetViewMatrix(), camera->GetProjectionMatrix());
+}
+
+void CameraUniforms::Set(const glm::mat4 &view, const glm::mat4 &projection)
+{
+	if (valid && memcmp(glm::value_ptr(block.view), glm::value_ptr(view), sizeof(glm::mat4)) == 0 &&
+		memcmp(glm::value_ptr(block.projection), glm::value_ptr(projection), sizeof(glm::mat4)) == 0)
+	{
+		return;
+	}
+
+	block.view = view;
+	block.projection = projection;
+
+	if (!buffer)
+	{
+		glGenBuffers(1, &buffer);
+		RenderState::BindBuffer(GL_UNIFORM_BUFFER, buffer);
+		glBufferData(GL_UNIFORM_BUFFER, sizeof(Block), &block, GL_DYNAMIC_DRAW);
+		RenderState::BindBufferBase(GL_UNIFORM_BUFFER, CAMERA_UNIFORM_BINDING, buffer);
+	}
+	else
+	{
+		RenderState::BindBuffer(GL_UNIFORM_BUFFER, buffer);
+		glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(Block), &block);
+	}
+
+	valid = true;
+	CheckOpenGLError();
+}
+
+void CameraUniforms::Invalidate()
+{
+	valid = false;
+}
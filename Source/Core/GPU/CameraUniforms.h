@@ -0,0 +1,44 @@
+#pragma once
+
+#include <include/gl.h>
+#include <include/glm.h>
+
+namespace EngineComponents
+{
+	class Camera;
+}
+
+// std140 uniform block "Camera" shared by every shader, always bound to CAMERA_UNIFORM_BINDING
+//
+//	layout(std140) uniform Camera
+//	{
+//		mat4 View;
+//		mat4 Projection;
+//	};
+//
+// The matrices are only uploaded when they differ from the ones already in the buffer,
+// so setting the same camera before every draw costs a comparison, not a transfer.
+class CameraUniforms
+{
+	public:
+		static void Set(const EngineComponents::Camera *camera);
+		static void Set(const glm::mat4 &view, const glm::mat4 &projection);
+
+		// Forces the next Set() to upload, e.g. after the context was recreated
+		static void Invalidate();
+
+	protected:
+		CameraUniforms() = delete;
+		~CameraUniforms() = delete;
+
+	private:
+		struct Block
+		{
+			glm::mat4 view;
+			glm::mat4 projection;
+		};
+
+		static GLuint buffer;
+		static Block block;
+		static bool valid;
+};
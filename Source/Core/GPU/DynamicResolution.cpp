@@ -0,0 +1,176 @@
+#include "DynamicResolution.h"
+
+#include <cmath>
+#include <algorithm>
+
+#include <include/utils.h>
+
+namespace
+{
+	// Weight of the newest frame in the smoothed time
+	const float SMOOTHING = 0.1f;
+
+	// The scale is kept while the time stays between these fractions of the budget
+	const float LOWER_BAND = 0.75f;
+	const float UPPER_BAND = 1.0f;
+
+	// Scaled for this fraction of the budget, leaves some room for the frames that vary
+	const float TARGET = 0.85f;
+
+	// Frames to wait after a change, the new time needs a few frames to show up in the queries
+	const int COOLDOWN_FRAMES = 15;
+}
+
+const float DynamicResolution::SCALE_STEP = 1.0f / 16.0f;
+
+DynamicResolution::DynamicResolution()
+{
+	for (int i = 0; i < QUERIES_RING; i++)
+	{
+		beginQueries[i] = 0;
+		endQueries[i] = 0;
+		pending[i] = false;
+	}
+	current = 0;
+
+	enabled = false;
+	budget = 1000.0f / 60.0f;
+	minScale = 0.5f;
+	maxScale = 1.0f;
+	scale = 1.0f;
+	frameTime = 0.0f;
+	stableFrames = 0;
+}
+
+DynamicResolution::~DynamicResolution()
+{
+	if (beginQueries[0])
+	{
+		glDeleteQueries(QUERIES_RING, beginQueries);
+		glDeleteQueries(QUERIES_RING, endQueries);
+	}
+}
+
+void DynamicResolution::BeginFrame()
+{
+	if (!enabled)
+		return;
+
+	if (!beginQueries[0])
+	{
+		glGenQueries(QUERIES_RING, beginQueries);
+		glGenQueries(QUERIES_RING, endQueries);
+	}
+
+	current = (current + 1) % QUERIES_RING;
+	ReadFrame(current);
+	UpdateScale();
+
+	glQueryCounter(beginQueries[current], GL_TIMESTAMP);
+}
+
+void DynamicResolution::EndFrame()
+{
+	if (!enabled || !beginQueries[0])
+		return;
+
+	glQueryCounter(endQueries[current], GL_TIMESTAMP);
+	pending[current] = true;
+}
+
+void DynamicResolution::SetEnabled(bool enabled)
+{
+	this->enabled = enabled;
+	scale = enabled ? maxScale : 1.0f;
+	frameTime = 0.0f;
+	stableFrames = 0;
+
+	// The queries of the old frames measured another scale
+	for (int i = 0; i < QUERIES_RING; i++)
+		pending[i] = false;
+}
+
+bool DynamicResolution::IsEnabled() const
+{
+	return enabled;
+}
+
+void DynamicResolution::SetBudget(float milliseconds)
+{
+	budget = milliseconds;
+}
+
+float DynamicResolution::GetBudget() const
+{
+	return budget;
+}
+
+void DynamicResolution::SetScaleLimits(float minScale, float maxScale)
+{
+	this->minScale = minScale;
+	this->maxScale = maxScale;
+	scale = glm::clamp(scale, minScale, maxScale);
+}
+
+float DynamicResolution::GetScale() const
+{
+	return enabled ? scale : 1.0f;
+}
+
+glm::ivec2 DynamicResolution::GetResolution(const glm::ivec2 &fullResolution) const
+{
+	glm::vec2 scaled = glm::vec2(fullResolution) * GetScale();
+	return glm::max(glm::ivec2(glm::round(scaled)), glm::ivec2(1));
+}
+
+float DynamicResolution::GetFrameTime() const
+{
+	return frameTime;
+}
+
+void DynamicResolution::ReadFrame(int slot)
+{
+	if (!pending[slot])
+		return;
+
+	// Dropped if the GPU is still that far behind, the slot is reused anyway
+	pending[slot] = false;
+	GLint available = 0;
+	glGetQueryObjectiv(endQueries[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+	if (!available)
+		return;
+
+	GLuint64 begin = 0, end = 0;
+	glGetQueryObjectui64v(beginQueries[slot], GL_QUERY_RESULT, &begin);
+	glGetQueryObjectui64v(endQueries[slot], GL_QUERY_RESULT, &end);
+
+	// The frames still in flight when the scale changed measured the old one
+	stableFrames++;
+	if (stableFrames <= QUERIES_RING)
+		return;
+
+	float milliseconds = static_cast<float>(end - begin) / 1000000.0f;
+	frameTime = frameTime > 0.0f ? frameTime + SMOOTHING * (milliseconds - frameTime) : milliseconds;
+}
+
+void DynamicResolution::UpdateScale()
+{
+	if (frameTime <= 0.0f || stableFrames < COOLDOWN_FRAMES)
+		return;
+
+	if (frameTime >= LOWER_BAND * budget && frameTime <= UPPER_BAND * budget)
+		return;
+
+	// The time follows the pixels count, the square of the scale
+	float target = scale * std::sqrt(TARGET * budget / frameTime);
+	target = std::floor(target / SCALE_STEP + 0.5f) * SCALE_STEP;
+	target = glm::clamp(target, minScale, maxScale);
+	if (target == scale)
+		return;
+
+	scale = target;
+	stableFrames = 0;
+
+	// The smoothed time belonged to the old scale
+	frameTime = 0.0f;
+}
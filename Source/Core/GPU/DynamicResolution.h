@@ -0,0 +1,60 @@
+#pragma once
+
+#include <include/gl.h>
+#include <include/glm.h>
+
+// Scale of the internal resolution, adjusted to keep the GPU time of a frame under a budget.
+// The frame is measured with two GL_TIMESTAMP queries, read back a few frames later from a ring
+// so the CPU never waits for the GPU. The cost is taken as proportional to the pixels count, the
+// scale moves in steps of SCALE_STEP and waits a few frames between changes, the targets sized
+// from it are only reallocated now and then.
+class DynamicResolution
+{
+	public:
+		DynamicResolution();
+		~DynamicResolution();
+
+		// Around all the GPU work of the frame
+		void BeginFrame();
+		void EndFrame();
+
+		void SetEnabled(bool enabled);
+		bool IsEnabled() const;
+
+		void SetBudget(float milliseconds);
+		float GetBudget() const;
+		void SetScaleLimits(float minScale, float maxScale);
+
+		// 1 while disabled
+		float GetScale() const;
+
+		// The full resolution scaled, at least 1 x 1
+		glm::ivec2 GetResolution(const glm::ivec2 &fullResolution) const;
+
+		// Smoothed GPU time of a frame in milliseconds, 0 until the first one is read
+		float GetFrameTime() const;
+
+		static const int QUERIES_RING = 4;
+		static const float SCALE_STEP;
+
+	private:
+		// Reads the slot about to be reused, if the GPU is done with it
+		void ReadFrame(int slot);
+		void UpdateScale();
+
+	private:
+		GLuint beginQueries[QUERIES_RING];
+		GLuint endQueries[QUERIES_RING];
+		bool pending[QUERIES_RING];
+		int current;
+
+		bool enabled;
+		float budget;
+		float minScale;
+		float maxScale;
+		float scale;
+		float frameTime;
+
+		// Frames since the scale last changed
+		int stableFrames;
+};
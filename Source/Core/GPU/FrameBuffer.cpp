@@ -4,6 +4,7 @@
 
 #include <include/gl.h>
 #include <Core/GPU/Shader.h>
+#include <Core/GPU/RenderState.h>
 #include <Core/GPU/Texture2D.h>
 #include <Core/Window/WindowCallbacks.h>
 
@@ -31,7 +32,26 @@ void FrameBuffer::Clean()
 {
 	if (FBO)
 		glDeleteFramebuffers(1, &FBO);
+	FBO = 0;
+
+	// Texture2D doesn't own its GL texture, the attachments are deleted here
+	if (textures)
+	{
+		for (unsigned int i = 0; i < nrTextures; i++)
+		{
+			GLuint textureID = textures[i].GetTextureID();
+			RenderState::DeleteTextures(1, &textureID);
+		}
+	}
+
+	if (depthTexture)
+	{
+		GLuint textureID = depthTexture->GetTextureID();
+		RenderState::DeleteTextures(1, &textureID);
+	}
+
 	SAFE_FREE_ARRAY(textures);
+	SAFE_FREE(depthTexture);
 	SAFE_FREE_ARRAY(DrawBuffers)
 }
 
@@ -1,5 +1,7 @@
 #include "GPUBuffers.h"
 
+#include <Core/GPU/RenderState.h>
+
 using namespace std;
 
 enum VERTEX_ATTRIBUTE_LOC
@@ -27,8 +29,8 @@ void GPUBuffers::ReleaseMemory()
 {
 	if (size) {
 		size = 0;
-		glDeleteVertexArrays(1, &VAO);
-		glDeleteBuffers(size, VBO);
+		RenderState::DeleteVertexArrays(1, &VAO);
+		RenderState::DeleteBuffers(size, VBO);
 	}
 }
 
@@ -40,7 +42,7 @@ namespace UtilsGPU
 	{
 		GPUBuffers buffers;
 		buffers.CreateBuffers(3);
-		glBindVertexArray(buffers.VAO);
+		RenderState::BindVertexArray(buffers.VAO);
 
 		// Generate and populate the buffers with vertex attributes and the indices
 		glBindBuffer(GL_ARRAY_BUFFER, buffers.VBO[0]);
@@ -57,7 +59,7 @@ namespace UtilsGPU
 		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices[0]) * indices.size(), &indices[0], GL_STATIC_DRAW);
 
 		// Make sure the VAO is not changed from the outside
-		glBindVertexArray(0);
+		RenderState::BindVertexArray(0);
 
 		CheckOpenGLError();
 
@@ -72,7 +74,7 @@ namespace UtilsGPU
 		// Create the VAO
 		GPUBuffers buffers;
 		buffers.CreateBuffers(4);
-		glBindVertexArray(buffers.VAO);
+		RenderState::BindVertexArray(buffers.VAO);
 
 		// Generate and populate the buffers with vertex attributes and the indices
 		glBindBuffer(GL_ARRAY_BUFFER, buffers.VBO[0]);
@@ -94,7 +96,7 @@ namespace UtilsGPU
 		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices[0]) * indices.size(), &indices[0], GL_STATIC_DRAW);
 
 		// Make sure the VAO is not changed from the outside
-		glBindVertexArray(0);
+		RenderState::BindVertexArray(0);
 		CheckOpenGLError();
 
 		return buffers;
@@ -105,7 +107,7 @@ namespace UtilsGPU
 		// Create the VAO
 		GPUBuffers buffers;
 		buffers.CreateBuffers(2);
-		glBindVertexArray(buffers.VAO);
+		RenderState::BindVertexArray(buffers.VAO);
 
 		// Generate and populate the buffers with vertex attributes and the indices
 		glBindBuffer(GL_ARRAY_BUFFER, buffers.VBO[0]);
@@ -127,7 +129,7 @@ namespace UtilsGPU
 		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices[0]) * indices.size(), &indices[0], GL_STATIC_DRAW);
 
 		// Make sure the VAO is not changed from the outside
-		glBindVertexArray(0);
+		RenderState::BindVertexArray(0);
 		CheckOpenGLError();
 
 		return buffers;
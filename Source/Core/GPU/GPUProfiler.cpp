@@ -0,0 +1,219 @@
+#include "GPUProfiler.h"
+
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+
+#include <include/utils.h>
+
+bool GPUProfiler::enabled = false;
+bool GPUProfiler::frameOpen = false;
+int GPUProfiler::current = 0;
+GPUProfiler::Frame GPUProfiler::frames[QUERY_FRAMES];
+std::vector<int> GPUProfiler::openMarkers;
+std::vector<GPUProfiler::Pass> GPUProfiler::passes;
+std::unordered_map<std::string, int> GPUProfiler::passIndices;
+
+GPUProfiler::Scope::Scope(const char *name)
+{
+	GPUProfiler::Begin(name);
+}
+
+GPUProfiler::Scope::~Scope()
+{
+	GPUProfiler::End();
+}
+
+void GPUProfiler::SetEnabled(bool enabled)
+{
+	GPUProfiler::enabled = enabled;
+
+	// The frames in flight are dropped, their queries stay in the pools
+	for (auto &frame : frames)
+	{
+		frame.markers.clear();
+		frame.usedQueries = 0;
+	}
+	openMarkers.clear();
+	frameOpen = false;
+}
+
+bool GPUProfiler::IsEnabled()
+{
+	return enabled;
+}
+
+void GPUProfiler::BeginFrame()
+{
+	if (!enabled)
+		return;
+
+	current = (current + 1) % QUERY_FRAMES;
+	ReadFrame(frames[current]);
+
+	frames[current].markers.clear();
+	frames[current].usedQueries = 0;
+	openMarkers.clear();
+	frameOpen = true;
+}
+
+void GPUProfiler::EndFrame()
+{
+	// Scopes left open are closed with the frame
+	while (frameOpen && !openMarkers.empty())
+		End();
+
+	frameOpen = false;
+}
+
+void GPUProfiler::Begin(const char *name)
+{
+	if (!enabled || !frameOpen)
+		return;
+
+	Frame &frame = frames[current];
+
+	Marker marker;
+	marker.pass = GetPass(name, static_cast<int>(openMarkers.size()));
+	marker.beginQuery = NextQuery(frame);
+	marker.endQuery = -1;
+	glQueryCounter(frame.queries[marker.beginQuery], GL_TIMESTAMP);
+
+	openMarkers.push_back(static_cast<int>(frame.markers.size()));
+	frame.markers.push_back(marker);
+}
+
+void GPUProfiler::End()
+{
+	if (!enabled || !frameOpen || openMarkers.empty())
+		return;
+
+	Frame &frame = frames[current];
+	Marker &marker = frame.markers[openMarkers.back()];
+	openMarkers.pop_back();
+
+	marker.endQuery = NextQuery(frame);
+	glQueryCounter(frame.queries[marker.endQuery], GL_TIMESTAMP);
+}
+
+std::vector<GPUProfiler::PassStatistics> GPUProfiler::GetStatistics()
+{
+	std::vector<PassStatistics> statistics;
+	std::vector<float> sorted;
+	for (auto &pass : passes)
+	{
+		PassStatistics entry;
+		entry.name = pass.name;
+		entry.depth = pass.depth;
+		entry.samples = pass.samples;
+		entry.last = 0;
+		entry.average = 0;
+		entry.p99 = 0;
+
+		unsigned int count = std::min(pass.samples, static_cast<unsigned int>(HISTORY_SIZE));
+		if (count > 0)
+		{
+			entry.last = pass.history[(pass.samples - 1) % HISTORY_SIZE];
+
+			sorted.assign(pass.history, pass.history + count);
+			for (float time : sorted)
+				entry.average += time;
+			entry.average /= count;
+
+			// Nearest rank
+			size_t rank = static_cast<size_t>(std::ceil(0.99f * count)) - 1;
+			std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+			entry.p99 = sorted[rank];
+		}
+		statistics.push_back(entry);
+	}
+	return statistics;
+}
+
+void GPUProfiler::Print()
+{
+	if (!enabled)
+	{
+		std::cout << "GPU profiler: off" << std::endl;
+		return;
+	}
+
+	std::cout << "GPU profiler, milliseconds over the last " << HISTORY_SIZE << " frames (average / p99 / last)" << std::endl;
+	std::cout << std::fixed << std::setprecision(3);
+	for (auto &pass : GetStatistics())
+	{
+		std::cout << std::string(2 * pass.depth + 2, ' ') << std::left << std::setw(24 - 2 * pass.depth) << pass.name
+				  << std::right << std::setw(8) << pass.average << std::setw(8) << pass.p99 << std::setw(8) << pass.last << std::endl;
+	}
+	std::cout << std::defaultfloat;
+}
+
+int GPUProfiler::GetPass(const char *name, int depth)
+{
+	auto found = passIndices.find(name);
+	if (found != passIndices.end())
+		return found->second;
+
+	Pass pass;
+	pass.name = name;
+	pass.depth = depth;
+	pass.samples = 0;
+	pass.frameTime = 0;
+	pass.inFrame = false;
+	passes.push_back(pass);
+
+	int index = static_cast<int>(passes.size()) - 1;
+	passIndices[pass.name] = index;
+	return index;
+}
+
+int GPUProfiler::NextQuery(Frame &frame)
+{
+	if (frame.usedQueries == static_cast<int>(frame.queries.size()))
+	{
+		// Grows by a few queries at a time, they are reused every QUERY_FRAMES frames
+		size_t first = frame.queries.size();
+		frame.queries.resize(first + 16);
+		glGenQueries(16, &frame.queries[first]);
+	}
+	return frame.usedQueries++;
+}
+
+void GPUProfiler::ReadFrame(Frame &frame)
+{
+	if (frame.markers.empty())
+		return;
+
+	// Timestamps complete in order, the last one being ready means the whole frame is
+	GLint available = 0;
+	glGetQueryObjectiv(frame.queries[frame.usedQueries - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+	if (!available)
+		return;
+
+	for (auto &marker : frame.markers)
+	{
+		if (marker.endQuery < 0)
+			continue;
+
+		GLuint64 begin = 0, end = 0;
+		glGetQueryObjectui64v(frame.queries[marker.beginQuery], GL_QUERY_RESULT, &begin);
+		glGetQueryObjectui64v(frame.queries[marker.endQuery], GL_QUERY_RESULT, &end);
+
+		Pass &pass = passes[marker.pass];
+		pass.frameTime += static_cast<float>(end - begin) / 1000000.0f;
+		pass.inFrame = true;
+	}
+
+	for (auto &pass : passes)
+	{
+		if (!pass.inFrame)
+			continue;
+
+		pass.history[pass.samples % HISTORY_SIZE] = pass.frameTime;
+		pass.samples++;
+		pass.frameTime = 0;
+		pass.inFrame = false;
+	}
+	CheckOpenGLError();
+}
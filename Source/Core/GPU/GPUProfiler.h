@@ -0,0 +1,105 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include <include/gl.h>
+
+// GPU time of named passes, measured with GL_TIMESTAMP queries written when a scope opens and
+// when it closes, so the scopes can nest. The queries of a frame are read QUERY_FRAMES frames
+// later, when the GPU is done with them, and the CPU never waits for a result.
+// Each pass keeps its last HISTORY_SIZE times for a rolling average and the 99th percentile.
+// Nothing is measured while the profiler is disabled.
+class GPUProfiler
+{
+	public:
+		struct PassStatistics
+		{
+			std::string name;
+
+			// Of the scopes open around it
+			int depth;
+
+			// Milliseconds
+			float last;
+			float average;
+			float p99;
+			unsigned int samples;
+		};
+
+		// Closes the pass when it goes out of scope
+		class Scope
+		{
+			public:
+				Scope(const char *name);
+				~Scope();
+		};
+
+	public:
+		static void SetEnabled(bool enabled);
+		static bool IsEnabled();
+
+		// Around everything drawn in the frame, World::LoopUpdate calls them
+		static void BeginFrame();
+		static void EndFrame();
+
+		// Scopes of the same name in a frame add up to one sample
+		static void Begin(const char *name);
+		static void End();
+
+		// In the order the passes were first seen
+		static std::vector<PassStatistics> GetStatistics();
+		static void Print();
+
+		static const int QUERY_FRAMES = 4;
+		static const int HISTORY_SIZE = 128;
+
+	protected:
+		GPUProfiler() = delete;
+		~GPUProfiler() = delete;
+
+	private:
+		struct Pass
+		{
+			std::string name;
+			int depth;
+			float history[HISTORY_SIZE];
+			unsigned int samples;
+
+			// Summed over the scopes of the frame being read
+			float frameTime;
+			bool inFrame;
+		};
+
+		// A scope of a frame, the queries come from the pool of its frame
+		struct Marker
+		{
+			int pass;
+			int beginQuery;
+			int endQuery;
+		};
+
+		struct Frame
+		{
+			std::vector<GLuint> queries;
+			int usedQueries;
+			std::vector<Marker> markers;
+		};
+
+		static int GetPass(const char *name, int depth);
+		static int NextQuery(Frame &frame);
+
+		// Adds the times of the frame to the history of its passes
+		static void ReadFrame(Frame &frame);
+
+	private:
+		static bool enabled;
+		static bool frameOpen;
+		static int current;
+		static Frame frames[QUERY_FRAMES];
+		static std::vector<int> openMarkers;
+
+		static std::vector<Pass> passes;
+		static std::unordered_map<std::string, int> passIndices;
+};
@@ -3,6 +3,7 @@
 #include <include/utils.h>
 
 #include <Core/GPU/GPUBuffers.h>
+#include <Core/GPU/RenderState.h>
 #include <Core/GPU/Texture2D.h>
 #include <Core/Managers/TextureManager.h>
 
@@ -31,6 +32,11 @@ const GPUBuffers * Mesh::GetBuffers() const
 	return buffers;
 }
 
+const std::vector<MeshEntry>& Mesh::GetMeshEntries() const
+{
+	return meshEntries;
+}
+
 const char * Mesh::GetMeshID() const
 {
 	return meshID.c_str();
@@ -255,7 +261,7 @@ void Mesh::UseMaterials(bool value)
 
 void Mesh::Render() const
 {
-	glBindVertexArray(buffers->VAO);
+	RenderState::BindVertexArray(buffers->VAO);
 	for (unsigned int i = 0; i < meshEntries.size(); i++)
 	{
 		if (useMaterial)
@@ -274,5 +280,4 @@ void Mesh::Render() const
 			GL_UNSIGNED_SHORT, (void*)(sizeof(unsigned short) * meshEntries[i].baseIndex),
 			meshEntries[i].baseVertex);
 	}
-	glBindVertexArray(0);
 }
@@ -105,6 +105,7 @@ class Mesh
 		void Render() const;
 
 		const GPUBuffers* GetBuffers() const;
+		const std::vector<MeshEntry>& GetMeshEntries() const;
 		const char* GetMeshID() const;
 
 	protected:
@@ -9,6 +9,8 @@
 #include <Component/Transform/Transform.h>
 
 #include <Core/GPU/Shader.h>
+#include <Core/GPU/CameraUniforms.h>
+#include <Core/GPU/RenderState.h>
 #include <Core/GPU/Texture2D.h>
 #include <Core/GPU/SSBO.h>
 
@@ -70,6 +72,7 @@ void ParticleEffect<T>::Render(Camera *camera, Shader *shader, unsigned int nrPa
 {
 	// Bind MVP
 	glUniformMatrix4fv(shader->loc_model_matrix, 1, GL_FALSE, glm::value_ptr(source->GetModel()));
+	CameraUniforms::Set(camera->View, camera->Projection);
 	glUniformMatrix4fv(shader->loc_view_matrix, 1, false, glm::value_ptr(camera->View));
 	glUniformMatrix4fv(shader->loc_projection_matrix, 1, false, glm::value_ptr(camera->Projection));
 	glUniform3fv(shader->loc_eye_pos, 1, glm::value_ptr(camera->transform->GetWorldPosition()));
@@ -78,9 +81,8 @@ void ParticleEffect<T>::Render(Camera *camera, Shader *shader, unsigned int nrPa
 	particles->BindBuffer(0);
 
 	// Render Particles
-	glBindVertexArray(VAO);
+	RenderState::BindVertexArray(VAO);
 	glDrawElements(GL_POINTS, MIN(particleCount, nrParticles), GL_UNSIGNED_INT, 0);
-	glBindVertexArray(0);
 }
 
 template <class T>
@@ -92,16 +94,12 @@ void ParticleEffect<T>::Render(Camera *camera, Shader *shader, float deltaTime,
 	shader->Use();
 
 	// Send frame time to shader
-	int loc = glGetUniformLocation(shader->program, "delta_time");
-	glUniform1f(loc, deltaTime);
+	shader->SetUniform("delta_time", deltaTime);
 
 	// Send effect specific parameters
-	loc = glGetUniformLocation(shader->program, "decay_radius");
-	glUniform1f(loc, decayRadius);
-	loc = glGetUniformLocation(shader->program, "particle_size");
-	glUniform1f(loc, particleSize);
-	loc = glGetUniformLocation(shader->program, "fall_speed");
-	glUniform3fv(loc, 1, glm::value_ptr(fallSpeed));
+	shader->SetUniform("decay_radius", decayRadius);
+	shader->SetUniform("particle_size", particleSize);
+	shader->SetUniform("fall_speed", fallSpeed);
 
 	if (particleTexture)
 	{
@@ -110,12 +108,6 @@ void ParticleEffect<T>::Render(Camera *camera, Shader *shader, float deltaTime,
 	}
 	
 	Render(camera, shader, nrParticles);
-
-	// Unbind texture
-	if (particleTexture)
-	{
-		particleTexture->UnBind();
-	}
 }
 
 template <class T>
@@ -137,13 +129,13 @@ void ParticleEffect<T>::Generate(unsigned int particleCount, bool createLocalBuf
 	GLuint IBO;
 
 	glGenVertexArrays(1, &VAO);
-	glBindVertexArray(VAO);
+	RenderState::BindVertexArray(VAO);
 
 	glGenBuffers(1, &IBO);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, IBO);
 	glBufferData(GL_ELEMENT_ARRAY_BUFFER, particleCount * sizeof(unsigned int), indices, GL_STATIC_DRAW);
 
-	glBindVertexArray(0);
+	RenderState::BindVertexArray(0);
 
 	delete[] indices;
 }
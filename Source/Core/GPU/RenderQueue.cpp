@@ -0,0 +1,307 @@
+#include "RenderQueue.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <include/utils.h>
+#include <Component/Camera/Camera.h>
+#include <Core/GPU/Mesh.h>
+#include <Core/GPU/GPUBuffers.h>
+#include <Core/GPU/Shader.h>
+#include <Core/GPU/Texture2D.h>
+#include <Core/GPU/CameraUniforms.h>
+#include <Core/GPU/RenderState.h>
+
+RenderQueue::RenderQueue()
+{
+	modelBuffer = 0;
+	commandBuffer = 0;
+	modelCapacity = 0;
+	commandCapacity = 0;
+	statistics = { 0, 0, 0 };
+}
+
+RenderQueue::~RenderQueue()
+{
+	if (modelBuffer)
+	{
+		RenderState::DeleteBuffers(1, &modelBuffer);
+		RenderState::DeleteBuffers(1, &commandBuffer);
+	}
+}
+
+void RenderQueue::Submit(Mesh *mesh, Shader *shader, Texture2D *texture, const glm::mat4 &model, RenderPass pass)
+{
+	if (!mesh || !shader || !shader->program)
+		return;
+
+	Packet packet;
+	packet.key = 0;
+	packet.mesh = mesh;
+	packet.shader = shader;
+	packet.texture = texture;
+	packet.pass = pass;
+	packet.model = model;
+	packets.push_back(packet);
+}
+
+void RenderQueue::Flush(const EngineComponents::Camera *camera)
+{
+	statistics.packets = static_cast<unsigned int>(packets.size());
+	statistics.drawCalls = 0;
+	statistics.indirectCommands = 0;
+	if (packets.empty())
+		return;
+
+	// The depth is only known once the camera is
+	glm::mat4 view = camera->GetViewMatrix();
+	for (auto &packet : packets)
+	{
+		float depth = -(view * packet.model[3]).z;
+		GLuint texture = packet.texture ? packet.texture->GetTextureID() : 0;
+		packet.key = MakeKey(packet.pass, packet.shader->program, texture, depth);
+	}
+
+	std::stable_sort(packets.begin(), packets.end(), [](const Packet &a, const Packet &b)
+	{
+		return a.key < b.key;
+	});
+
+	// Split the sorted packets in runs that share the state, one command for each mesh entry
+	runs.clear();
+	commands.clear();
+	for (size_t i = 0; i < packets.size();)
+	{
+		Run run;
+		run.first = i;
+		run.batched = CanBatch(packets[i]);
+		run.firstCommand = commands.size();
+
+		size_t last = i + 1;
+		if (run.batched)
+		{
+			while (last < packets.size() && SameBatch(packets[i], packets[last]))
+				last++;
+
+			for (size_t j = i; j < last; j++)
+			{
+				for (auto &entry : packets[j].mesh->GetMeshEntries())
+				{
+					DrawCommand command = { entry.nrIndices, 1, entry.baseIndex, entry.baseVertex, static_cast<GLuint>(j) };
+					commands.push_back(command);
+				}
+			}
+		}
+
+		run.last = last;
+		run.lastCommand = commands.size();
+		runs.push_back(run);
+		i = last;
+	}
+
+	UploadBatches();
+
+	RenderPass pass = packets.front().pass;
+	SetPassState(pass);
+	for (auto &run : runs)
+	{
+		if (packets[run.first].pass != pass)
+		{
+			pass = packets[run.first].pass;
+			SetPassState(pass);
+		}
+
+		if (run.batched)
+		{
+			DrawBatch(run, camera);
+			continue;
+		}
+
+		for (size_t i = run.first; i < run.last; i++)
+			DrawPacket(packets[i], camera);
+	}
+
+	SetPassState(RENDER_PASS_OPAQUE);
+	CheckOpenGLError();
+
+	packets.clear();
+}
+
+void RenderQueue::Clear()
+{
+	packets.clear();
+}
+
+bool RenderQueue::IsEmpty() const
+{
+	return packets.empty();
+}
+
+const RenderQueue::Statistics& RenderQueue::GetStatistics() const
+{
+	return statistics;
+}
+
+uint64_t RenderQueue::MakeKey(RenderPass pass, GLuint program, GLuint texture, float depth)
+{
+	// Positive floats keep their order when compared as integers
+	depth = std::max(depth, 0.0f);
+	uint32_t depthBits;
+	memcpy(&depthBits, &depth, sizeof(depthBits));
+
+	uint64_t key = static_cast<uint64_t>(pass & 0xF) << 60;
+	uint64_t state = (static_cast<uint64_t>(program & 0xFFF) << 16) | (texture & 0xFFFF);
+
+	// Blending needs the far packets first, whatever their state is
+	if (pass == RENDER_PASS_TRANSPARENT)
+		return key | (static_cast<uint64_t>(~depthBits) << 28) | state;
+
+	return key | (state << 32) | depthBits;
+}
+
+bool RenderQueue::CanBatch(const Packet &packet) const
+{
+	if (!packet.texture || !packet.mesh->GetBuffers() || !packet.mesh->GetBuffers()->VAO)
+		return false;
+
+	return packet.shader->loc_model_attribute == static_cast<GLint>(MODEL_ATTRIBUTE);
+}
+
+bool RenderQueue::SameBatch(const Packet &a, const Packet &b) const
+{
+	return a.pass == b.pass && a.shader == b.shader && a.texture == b.texture &&
+		a.mesh->GetBuffers()->VAO == b.mesh->GetBuffers()->VAO && a.mesh->GetDrawMode() == b.mesh->GetDrawMode();
+}
+
+void RenderQueue::UploadBatches()
+{
+	if (commands.empty())
+		return;
+
+	if (!modelBuffer)
+	{
+		glGenBuffers(1, &modelBuffer);
+		glGenBuffers(1, &commandBuffer);
+	}
+
+	// The base instance of a command is the index of its packet
+	models.resize(packets.size());
+	for (size_t i = 0; i < packets.size(); i++)
+		models[i] = packets[i].model;
+
+	glBindBuffer(GL_ARRAY_BUFFER, modelBuffer);
+	if (models.size() > modelCapacity)
+	{
+		modelCapacity = std::max(models.size(), 2 * modelCapacity);
+		glBufferData(GL_ARRAY_BUFFER, modelCapacity * sizeof(glm::mat4), nullptr, GL_STREAM_DRAW);
+	}
+	glBufferSubData(GL_ARRAY_BUFFER, 0, models.size() * sizeof(glm::mat4), models.data());
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	RenderState::BindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+	if (commands.size() > commandCapacity)
+	{
+		commandCapacity = std::max(commands.size(), 2 * commandCapacity);
+		glBufferData(GL_DRAW_INDIRECT_BUFFER, commandCapacity * sizeof(DrawCommand), nullptr, GL_STREAM_DRAW);
+	}
+	glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, commands.size() * sizeof(DrawCommand), commands.data());
+}
+
+void RenderQueue::DrawBatch(const Run &run, const EngineComponents::Camera *camera)
+{
+	const Packet &packet = packets[run.first];
+	Shader *shader = packet.shader;
+
+	shader->Use();
+	CameraUniforms::Set(camera);
+
+	// Shaders that still declare plain View and Projection uniforms instead of the Camera block
+	if (shader->loc_view_matrix >= 0)
+		glUniformMatrix4fv(shader->loc_view_matrix, 1, GL_FALSE, glm::value_ptr(camera->GetViewMatrix()));
+	if (shader->loc_projection_matrix >= 0)
+		glUniformMatrix4fv(shader->loc_projection_matrix, 1, GL_FALSE, glm::value_ptr(camera->GetProjectionMatrix()));
+
+	packet.texture->BindToTextureUnit(GL_TEXTURE0);
+	glUniform1i(shader->loc_textures[0], 0);
+
+	BindModelAttribute(packet.mesh->GetBuffers()->VAO);
+	RenderState::BindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+
+	GLenum mode = packet.mesh->GetDrawMode();
+	GLsizei count = static_cast<GLsizei>(run.lastCommand - run.firstCommand);
+	if (GLEW_ARB_multi_draw_indirect)
+	{
+		glMultiDrawElementsIndirect(mode, GL_UNSIGNED_SHORT, (void*)(run.firstCommand * sizeof(DrawCommand)), count, 0);
+		statistics.drawCalls++;
+	}
+	else
+	{
+		// Same commands, one call each
+		for (size_t i = run.firstCommand; i < run.lastCommand; i++)
+		{
+			const DrawCommand &command = commands[i];
+			glDrawElementsInstancedBaseVertexBaseInstance(mode, command.count, GL_UNSIGNED_SHORT,
+				(void*)(command.firstIndex * sizeof(unsigned short)), 1, command.baseVertex, command.baseInstance);
+		}
+		statistics.drawCalls += count;
+	}
+	statistics.indirectCommands += count;
+}
+
+void RenderQueue::DrawPacket(const Packet &packet, const EngineComponents::Camera *camera)
+{
+	Shader *shader = packet.shader;
+
+	shader->Use();
+	CameraUniforms::Set(camera);
+
+	// Shaders that still declare plain View and Projection uniforms instead of the Camera block
+	if (shader->loc_view_matrix >= 0)
+		glUniformMatrix4fv(shader->loc_view_matrix, 1, GL_FALSE, glm::value_ptr(camera->GetViewMatrix()));
+	if (shader->loc_projection_matrix >= 0)
+		glUniformMatrix4fv(shader->loc_projection_matrix, 1, GL_FALSE, glm::value_ptr(camera->GetProjectionMatrix()));
+
+	glUniformMatrix4fv(shader->loc_model_matrix, 1, GL_FALSE, glm::value_ptr(packet.model));
+
+	if (packet.texture)
+	{
+		packet.mesh->UseMaterials(false);
+		packet.texture->BindToTextureUnit(GL_TEXTURE0);
+		glUniform1i(shader->loc_textures[0], 0);
+	}
+	else
+	{
+		packet.mesh->UseMaterials(true);
+	}
+
+	packet.mesh->Render();
+	statistics.drawCalls++;
+}
+
+void RenderQueue::BindModelAttribute(GLuint VAO) const
+{
+	// The vertex array may be new or reused, so the attribute is set every flush
+	RenderState::BindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, modelBuffer);
+	for (GLuint i = 0; i < 4; i++)
+	{
+		glEnableVertexAttribArray(MODEL_ATTRIBUTE + i);
+		glVertexAttribPointer(MODEL_ATTRIBUTE + i, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(i * sizeof(glm::vec4)));
+		glVertexAttribDivisor(MODEL_ATTRIBUTE + i, 1);
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void RenderQueue::SetPassState(RenderPass pass) const
+{
+	if (pass == RENDER_PASS_TRANSPARENT)
+	{
+		RenderState::SetBlend(true);
+		RenderState::SetBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		RenderState::SetBlendEquation(GL_FUNC_ADD);
+	}
+	else
+	{
+		RenderState::SetBlend(false);
+	}
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include <include/gl.h>
+#include <include/glm.h>
+
+class Mesh;
+class Shader;
+class Texture2D;
+
+namespace EngineComponents
+{
+	class Camera;
+}
+
+enum RenderPass
+{
+	// Front to back, drawn first
+	RENDER_PASS_OPAQUE,
+
+	// Back to front with alpha blending, after everything opaque
+	RENDER_PASS_TRANSPARENT
+};
+
+// Meshes submitted during the frame and drawn together by Flush(), sorted by a 64 bit key:
+// pass (4 bits) | shader (12 bits) | texture (16 bits) | view depth (32 bits).
+// The transparent pass puts the reversed depth before the shader, blending needs the far packets first.
+// Consecutive packets with the same shader, texture and vertex array become a single
+// glMultiDrawElementsIndirect call, their model matrices are read from an instanced attribute
+// selected by the base instance of each command, so the shader has to declare
+//
+//	layout(location = 4) in mat4 v_model;
+//
+// Packets without a texture or with a shader that doesn't read v_model are drawn one by one
+// through the Model uniform, with the materials of the mesh.
+class RenderQueue
+{
+	public:
+		struct Statistics
+		{
+			unsigned int packets;
+			unsigned int drawCalls;
+			unsigned int indirectCommands;
+		};
+
+	public:
+		RenderQueue();
+		~RenderQueue();
+
+		void Submit(Mesh *mesh, Shader *shader, Texture2D *texture, const glm::mat4 &model,
+					RenderPass pass = RENDER_PASS_OPAQUE);
+
+		// Sorts and draws everything submitted since the last flush, then empties the queue
+		void Flush(const EngineComponents::Camera *camera);
+		void Clear();
+
+		bool IsEmpty() const;
+
+		// Of the last Flush()
+		const Statistics& GetStatistics() const;
+
+		static uint64_t MakeKey(RenderPass pass, GLuint program, GLuint texture, float depth);
+
+		// First location of the model matrix attribute, it takes 4
+		static const GLuint MODEL_ATTRIBUTE = 4;
+
+	private:
+		struct Packet
+		{
+			uint64_t key;
+			Mesh *mesh;
+			Shader *shader;
+			Texture2D *texture;
+			RenderPass pass;
+			glm::mat4 model;
+		};
+
+		// glDrawElementsIndirect command
+		struct DrawCommand
+		{
+			GLuint count;
+			GLuint instanceCount;
+			GLuint firstIndex;
+			GLint baseVertex;
+			GLuint baseInstance;
+		};
+
+		// Packets [first, last) drawn by commands [firstCommand, lastCommand), or one by one if batched is false
+		struct Run
+		{
+			size_t first;
+			size_t last;
+			size_t firstCommand;
+			size_t lastCommand;
+			bool batched;
+		};
+
+		bool CanBatch(const Packet &packet) const;
+		bool SameBatch(const Packet &a, const Packet &b) const;
+
+		void UploadBatches();
+		void DrawBatch(const Run &run, const EngineComponents::Camera *camera);
+		void DrawPacket(const Packet &packet, const EngineComponents::Camera *camera);
+
+		// Points the instanced model attribute of the vertex array at the model buffer
+		void BindModelAttribute(GLuint VAO) const;
+
+		void SetPassState(RenderPass pass) const;
+
+	private:
+		std::vector<Packet> packets;
+		std::vector<glm::mat4> models;
+		std::vector<DrawCommand> commands;
+		std::vector<Run> runs;
+
+		GLuint modelBuffer;
+		GLuint commandBuffer;
+		size_t modelCapacity;
+		size_t commandCapacity;
+
+		Statistics statistics;
+};
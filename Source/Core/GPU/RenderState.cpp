@@ -0,0 +1,295 @@
+#include "RenderState.h"
+
+#include <include/utils.h>
+
+namespace
+{
+	// Never returned by glGen*, marks the state that has to be submitted
+	const GLuint UNKNOWN = 0xFFFFFFFF;
+}
+
+GLuint RenderState::program = UNKNOWN;
+GLint RenderState::patchVertices = -1;
+GLuint RenderState::vertexArray = UNKNOWN;
+GLuint RenderState::activeTexture = UNKNOWN;
+GLuint RenderState::textures[MAX_TEXTURE_UNITS][TEXTURE_TARGETS];
+GLuint RenderState::buffers[BUFFER_TARGETS];
+GLuint RenderState::bufferBindings[BUFFER_TARGETS][MAX_BUFFER_BINDINGS];
+GLint RenderState::blend = -1;
+GLint RenderState::depthTest = -1;
+GLenum RenderState::blendSource = UNKNOWN;
+GLenum RenderState::blendDestination = UNKNOWN;
+GLenum RenderState::blendEquation = UNKNOWN;
+RenderState::Statistics RenderState::frame = { 0, 0 };
+RenderState::Statistics RenderState::lastFrame = { 0, 0 };
+
+void RenderState::UseProgram(GLuint program)
+{
+	if (!Changed(RenderState::program != program))
+		return;
+
+	glUseProgram(program);
+	RenderState::program = program;
+}
+
+void RenderState::SetPatchVertices(GLint count)
+{
+	#ifndef OPENGL_ES
+	if (!Changed(patchVertices != count))
+		return;
+
+	glPatchParameteri(GL_PATCH_VERTICES, count);
+	patchVertices = count;
+	#endif
+}
+
+void RenderState::BindVertexArray(GLuint VAO)
+{
+	if (!Changed(vertexArray != VAO))
+		return;
+
+	glBindVertexArray(VAO);
+	vertexArray = VAO;
+}
+
+void RenderState::ActiveTexture(GLuint unit)
+{
+	if (!Changed(activeTexture != unit))
+		return;
+
+	glActiveTexture(GL_TEXTURE0 + unit);
+	activeTexture = unit;
+}
+
+void RenderState::BindTexture(GLenum target, GLuint texture)
+{
+	int index = GetTextureTarget(target);
+	if (index < 0 || activeTexture >= MAX_TEXTURE_UNITS)
+	{
+		Changed(true);
+		glBindTexture(target, texture);
+		return;
+	}
+
+	if (!Changed(textures[activeTexture][index] != texture))
+		return;
+
+	glBindTexture(target, texture);
+	textures[activeTexture][index] = texture;
+}
+
+void RenderState::BindTextureUnit(GLuint unit, GLenum target, GLuint texture)
+{
+	// A texture already in place doesn't need the unit switch either
+	int index = GetTextureTarget(target);
+	if (index >= 0 && unit < MAX_TEXTURE_UNITS && textures[unit][index] == texture)
+	{
+		Changed(false);
+		return;
+	}
+
+	ActiveTexture(unit);
+	BindTexture(target, texture);
+}
+
+void RenderState::BindBuffer(GLenum target, GLuint buffer)
+{
+	int index = GetBufferTarget(target);
+	if (index < 0)
+	{
+		Changed(true);
+		glBindBuffer(target, buffer);
+		return;
+	}
+
+	if (!Changed(buffers[index] != buffer))
+		return;
+
+	glBindBuffer(target, buffer);
+	buffers[index] = buffer;
+}
+
+void RenderState::BindBufferBase(GLenum target, GLuint index, GLuint buffer)
+{
+	int targetIndex = GetBufferTarget(target);
+	if (targetIndex < 0 || index >= MAX_BUFFER_BINDINGS)
+	{
+		Changed(true);
+		glBindBufferBase(target, index, buffer);
+		if (targetIndex >= 0)
+			buffers[targetIndex] = buffer;
+		return;
+	}
+
+	if (!Changed(bufferBindings[targetIndex][index] != buffer))
+		return;
+
+	glBindBufferBase(target, index, buffer);
+	bufferBindings[targetIndex][index] = buffer;
+	buffers[targetIndex] = buffer;
+}
+
+void RenderState::SetBlend(bool enabled)
+{
+	if (!Changed(blend != static_cast<GLint>(enabled)))
+		return;
+
+	if (enabled)
+		glEnable(GL_BLEND);
+	else
+		glDisable(GL_BLEND);
+	blend = enabled;
+}
+
+void RenderState::SetBlendFunc(GLenum source, GLenum destination)
+{
+	if (!Changed(blendSource != source || blendDestination != destination))
+		return;
+
+	glBlendFunc(source, destination);
+	blendSource = source;
+	blendDestination = destination;
+}
+
+void RenderState::SetBlendEquation(GLenum mode)
+{
+	if (!Changed(blendEquation != mode))
+		return;
+
+	glBlendEquation(mode);
+	blendEquation = mode;
+}
+
+void RenderState::SetDepthTest(bool enabled)
+{
+	if (!Changed(depthTest != static_cast<GLint>(enabled)))
+		return;
+
+	if (enabled)
+		glEnable(GL_DEPTH_TEST);
+	else
+		glDisable(GL_DEPTH_TEST);
+	depthTest = enabled;
+}
+
+void RenderState::DeleteTextures(GLsizei count, const GLuint *textures)
+{
+	for (GLsizei i = 0; i < count; i++)
+	{
+		for (auto &unit : RenderState::textures)
+		{
+			for (auto &texture : unit)
+			{
+				if (texture == textures[i])
+					texture = 0;
+			}
+		}
+	}
+	glDeleteTextures(count, textures);
+}
+
+void RenderState::DeleteBuffers(GLsizei count, const GLuint *buffers)
+{
+	for (GLsizei i = 0; i < count; i++)
+	{
+		for (int target = 0; target < BUFFER_TARGETS; target++)
+		{
+			if (RenderState::buffers[target] == buffers[i])
+				RenderState::buffers[target] = 0;
+
+			for (auto &binding : bufferBindings[target])
+			{
+				if (binding == buffers[i])
+					binding = 0;
+			}
+		}
+	}
+	glDeleteBuffers(count, buffers);
+}
+
+void RenderState::DeleteVertexArrays(GLsizei count, const GLuint *arrays)
+{
+	for (GLsizei i = 0; i < count; i++)
+	{
+		if (vertexArray == arrays[i])
+			vertexArray = 0;
+	}
+	glDeleteVertexArrays(count, arrays);
+}
+
+void RenderState::Invalidate()
+{
+	program = UNKNOWN;
+	patchVertices = -1;
+	vertexArray = UNKNOWN;
+
+	activeTexture = UNKNOWN;
+	for (auto &unit : textures)
+	{
+		for (auto &texture : unit)
+			texture = UNKNOWN;
+	}
+
+	for (int target = 0; target < BUFFER_TARGETS; target++)
+	{
+		buffers[target] = UNKNOWN;
+		for (auto &binding : bufferBindings[target])
+			binding = UNKNOWN;
+	}
+
+	blend = -1;
+	depthTest = -1;
+	blendSource = UNKNOWN;
+	blendDestination = UNKNOWN;
+	blendEquation = UNKNOWN;
+}
+
+void RenderState::BeginFrame()
+{
+	lastFrame = frame;
+	frame.submitted = 0;
+	frame.elided = 0;
+	Invalidate();
+}
+
+const RenderState::Statistics& RenderState::GetFrameStatistics()
+{
+	return lastFrame;
+}
+
+int RenderState::GetTextureTarget(GLenum target)
+{
+	switch (target)
+	{
+	case GL_TEXTURE_2D:
+		return 0;
+	case GL_TEXTURE_CUBE_MAP:
+		return 1;
+	default:
+		return -1;
+	}
+}
+
+int RenderState::GetBufferTarget(GLenum target)
+{
+	switch (target)
+	{
+	case GL_SHADER_STORAGE_BUFFER:
+		return 0;
+	case GL_UNIFORM_BUFFER:
+		return 1;
+	case GL_DRAW_INDIRECT_BUFFER:
+		return 2;
+	default:
+		return -1;
+	}
+}
+
+bool RenderState::Changed(bool changed)
+{
+	if (changed)
+		frame.submitted++;
+	else
+		frame.elided++;
+	return changed;
+}
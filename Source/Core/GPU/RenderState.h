@@ -0,0 +1,92 @@
+#pragma once
+
+#include <include/gl.h>
+
+// Shadow copy of the OpenGL state that changes between draws: the program, the vertex array,
+// the textures of each unit, the storage, uniform and draw indirect buffer bindings, blending,
+// depth testing and the patch size. Calls that wouldn't change anything never reach the driver.
+//
+// The cache is only right while this state is changed through RenderState, after raw GL calls
+// Invalidate() has to be called. Objects must be deleted through it too, GL resets the bindings
+// of a deleted object to 0 and the name can be reused right away.
+// Array buffers aren't tracked, element buffers belong to the bound vertex array.
+class RenderState
+{
+	public:
+		// State changes requested in a frame, the elided ones were already set
+		struct Statistics
+		{
+			unsigned int submitted;
+			unsigned int elided;
+		};
+
+	public:
+		static void UseProgram(GLuint program);
+		static void SetPatchVertices(GLint count);
+		static void BindVertexArray(GLuint VAO);
+
+		// Texture units are indices, not GL_TEXTURE0 + i
+		static void ActiveTexture(GLuint unit);
+		static void BindTexture(GLenum target, GLuint texture);
+		static void BindTextureUnit(GLuint unit, GLenum target, GLuint texture);
+
+		// glBindBufferBase also changes the generic binding of the target
+		static void BindBuffer(GLenum target, GLuint buffer);
+		static void BindBufferBase(GLenum target, GLuint index, GLuint buffer);
+
+		static void SetBlend(bool enabled);
+		static void SetBlendFunc(GLenum source, GLenum destination);
+		static void SetBlendEquation(GLenum mode);
+		static void SetDepthTest(bool enabled);
+
+		static void DeleteTextures(GLsizei count, const GLuint *textures);
+		static void DeleteBuffers(GLsizei count, const GLuint *buffers);
+		static void DeleteVertexArrays(GLsizei count, const GLuint *arrays);
+
+		// Forgets everything, the next change of each state is always submitted
+		static void Invalidate();
+
+		// Closes the statistics of the last frame and invalidates the cache,
+		// the engine is free to change the state between frames
+		static void BeginFrame();
+		static const Statistics& GetFrameStatistics();
+
+		static const int MAX_TEXTURE_UNITS = 16;
+		static const int MAX_BUFFER_BINDINGS = 16;
+
+	protected:
+		RenderState() = delete;
+		~RenderState() = delete;
+
+	private:
+		// Index of the cached texture or buffer target, -1 for the ones passed through
+		static int GetTextureTarget(GLenum target);
+		static int GetBufferTarget(GLenum target);
+
+		// Counts the change, returns true if it has to be submitted
+		static bool Changed(bool changed);
+
+	private:
+		static const int TEXTURE_TARGETS = 2;
+		static const int BUFFER_TARGETS = 3;
+
+		static GLuint program;
+		static GLint patchVertices;
+		static GLuint vertexArray;
+
+		static GLuint activeTexture;
+		static GLuint textures[MAX_TEXTURE_UNITS][TEXTURE_TARGETS];
+
+		static GLuint buffers[BUFFER_TARGETS];
+		static GLuint bufferBindings[BUFFER_TARGETS][MAX_BUFFER_BINDINGS];
+
+		// -1 while unknown
+		static GLint blend;
+		static GLint depthTest;
+		static GLenum blendSource;
+		static GLenum blendDestination;
+		static GLenum blendEquation;
+
+		static Statistics frame;
+		static Statistics lastFrame;
+};
@@ -0,0 +1,65 @@
+#include "RenderTargetPool.h"
+
+#include <include/gl.h>
+#include <Core/GPU/FrameBuffer.h>
+#include <Core/GPU/Texture2D.h>
+
+RenderTargetPool::RenderTargetPool()
+{
+}
+
+RenderTargetPool::~RenderTargetPool()
+{
+	for (auto &target : targets)
+		target.frameBuffer->Clean();
+}
+
+FrameBuffer* RenderTargetPool::Acquire(const glm::ivec2 &resolution)
+{
+	for (auto &target : targets)
+	{
+		if (!target.used && target.resolution == resolution)
+		{
+			target.used = true;
+			return target.frameBuffer.get();
+		}
+	}
+
+	Target target;
+	target.frameBuffer = std::unique_ptr<FrameBuffer>(new FrameBuffer());
+	target.frameBuffer->Generate(resolution.x, resolution.y, 1, false, 16);
+	target.frameBuffer->GetTexture(0)->SetWrappingMode(GL_CLAMP_TO_EDGE);
+	target.resolution = resolution;
+	target.used = true;
+	targets.push_back(std::move(target));
+	return targets.back().frameBuffer.get();
+}
+
+void RenderTargetPool::Release(FrameBuffer *frameBuffer)
+{
+	for (auto &target : targets)
+	{
+		if (target.frameBuffer.get() == frameBuffer)
+			target.used = false;
+	}
+}
+
+void RenderTargetPool::Trim()
+{
+	for (size_t i = 0; i < targets.size();)
+	{
+		if (targets[i].used)
+		{
+			i++;
+			continue;
+		}
+
+		targets[i].frameBuffer->Clean();
+		targets.erase(targets.begin() + i);
+	}
+}
+
+int RenderTargetPool::GetTargetsCount() const
+{
+	return static_cast<int>(targets.size());
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+
+#include <include/glm.h>
+
+class FrameBuffer;
+
+// Half float color targets without depth, lent for as long as a pass needs them.
+// A released target goes back to the pool and is handed out again for the same resolution,
+// so a chain of passes only ever allocates the few targets it reads and writes at once.
+class RenderTargetPool
+{
+	public:
+		RenderTargetPool();
+		~RenderTargetPool();
+
+		// A free target of the resolution, created when there is none
+		FrameBuffer* Acquire(const glm::ivec2 &resolution);
+		void Release(FrameBuffer *target);
+
+		// Deletes the free targets, after a resize for example
+		void Trim();
+
+		int GetTargetsCount() const;
+
+	private:
+		struct Target
+		{
+			std::unique_ptr<FrameBuffer> frameBuffer;
+			glm::ivec2 resolution;
+			bool used;
+		};
+
+		std::vector<Target> targets;
+};
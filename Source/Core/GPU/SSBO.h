@@ -2,6 +2,8 @@
 
 #include <include/gl.h>
 
+#include <Core/GPU/RenderState.h>
+
 template <class StorageEntry>
 class SSBO
 {
@@ -17,7 +19,6 @@ class SSBO
 				glGenBuffers(1, &ssbo);
 				Bind();
 				glBufferData(GL_SHADER_STORAGE_BUFFER, memorySize, NULL, GL_DYNAMIC_DRAW);
-				Unbind();
 			}
 			#endif
 
@@ -25,7 +26,7 @@ class SSBO
 
 		~SSBO()
 		{
-			glDeleteBuffers(1, &ssbo);
+			RenderState::DeleteBuffers(1, &ssbo);
 			SAFE_FREE_ARRAY(data);
 		};
 
@@ -33,19 +34,17 @@ class SSBO
 		{
 			Bind();
 			glBufferData(GL_SHADER_STORAGE_BUFFER, memorySize, data, GL_DYNAMIC_DRAW);
-			Unbind();
 		}
 
 		void SetBufferSubData(const StorageEntry *data, int offset, int size)
 		{
 			Bind();
 			glBufferSubData(GL_SHADER_STORAGE_BUFFER, offset, size * sizeof(StorageEntry), data);
-			Unbind();
 		}
 
 		void BindBuffer(GLuint index) const
 		{
-			glBindBufferBase(GL_SHADER_STORAGE_BUFFER, index, ssbo);
+			RenderState::BindBufferBase(GL_SHADER_STORAGE_BUFFER, index, ssbo);
 		}
 
 		void ReadBuffer()
@@ -61,7 +60,6 @@ class SSBO
 			CheckOpenGLError();
 			glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
 			CheckOpenGLError();
-			Unbind();
 		}
 
 		const StorageEntry* GetBuffer() const
@@ -79,21 +77,14 @@ class SSBO
 			Bind();
 			uint value = 0;
 			glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED, GL_UNSIGNED_INT, &value);
-			Unbind();
 			CheckOpenGLError();
 		}
 
 	private:
+		// Left bound, binding it again before the next upload is free
 		inline void Bind() const
 		{
-			glBindBuffer(GL_SHADER_STORAGE_BUFFER, ssbo);
-			CheckOpenGLError();
-		}
-
-		static inline void Unbind()
-		{
-			glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
-			CheckOpenGLError();
+			RenderState::BindBuffer(GL_SHADER_STORAGE_BUFFER, ssbo);
 		}
 
 	private:
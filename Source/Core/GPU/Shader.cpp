@@ -2,13 +2,16 @@
 
 #include <fstream>
 #include <iostream>
+#include <cstring>
 #include <include/gl.h>
+#include <Core/GPU/RenderState.h>
 
 using namespace std;
 
 Shader::Shader(const char * name)
 {
 	program = 0;
+	patchVertices = 0;
 	shaderName = string(name);
 	shaderFiles.reserve(5);
 }
@@ -32,8 +35,12 @@ void Shader::Use() const
 {
 	if (program)
 	{
-		glUseProgram(program);
-		CheckOpenGLError();
+		RenderState::UseProgram(program);
+
+		// The patch size is context state, not part of the program
+		if (patchVertices)
+			RenderState::SetPatchVertices(patchVertices);
+
 	}
 }
 
@@ -57,7 +64,146 @@ void Shader::BindTexturesUnits()
 
 GLint Shader::GetUniformLocation(const char *uniformName) const
 {
-	return glGetUniformLocation(program, uniformName);
+	int index = FindUniform(uniformName);
+	return index == -1 ? INVALID_LOC : uniforms[index].location;
+}
+
+void Shader::SetUniform(const char *uniformName, int value)
+{
+	if (Uniform *uniform = GetChangedUniform(uniformName, &value, sizeof(value)))
+		glUniform1i(uniform->location, value);
+}
+
+void Shader::SetUniform(const char *uniformName, float value)
+{
+	if (Uniform *uniform = GetChangedUniform(uniformName, &value, sizeof(value)))
+		glUniform1f(uniform->location, value);
+}
+
+void Shader::SetUniform(const char *uniformName, const glm::vec2 &value)
+{
+	if (Uniform *uniform = GetChangedUniform(uniformName, glm::value_ptr(value), sizeof(value)))
+		glUniform2fv(uniform->location, 1, glm::value_ptr(value));
+}
+
+void Shader::SetUniform(const char *uniformName, const glm::vec3 &value)
+{
+	if (Uniform *uniform = GetChangedUniform(uniformName, glm::value_ptr(value), sizeof(value)))
+		glUniform3fv(uniform->location, 1, glm::value_ptr(value));
+}
+
+void Shader::SetUniform(const char *uniformName, const glm::vec4 &value)
+{
+	if (Uniform *uniform = GetChangedUniform(uniformName, glm::value_ptr(value), sizeof(value)))
+		glUniform4fv(uniform->location, 1, glm::value_ptr(value));
+}
+
+void Shader::SetUniform(const char *uniformName, const glm::ivec2 &value)
+{
+	if (Uniform *uniform = GetChangedUniform(uniformName, glm::value_ptr(value), sizeof(value)))
+		glUniform2iv(uniform->location, 1, glm::value_ptr(value));
+}
+
+void Shader::SetUniform(const char *uniformName, const glm::mat4 &value)
+{
+	if (Uniform *uniform = GetChangedUniform(uniformName, glm::value_ptr(value), sizeof(value)))
+		glUniformMatrix4fv(uniform->location, 1, GL_FALSE, glm::value_ptr(value));
+}
+
+void Shader::IntrospectUniforms()
+{
+	uniforms.clear();
+	uniformIndices.clear();
+
+	GLint count = 0, maxLength = 0;
+	glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+	glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+	vector<char> buffer(maxLength + 1);
+	for (GLint i = 0; i < count; i++)
+	{
+		GLsizei length = 0;
+		GLint size = 0;
+		GLenum type = 0;
+		glGetActiveUniform(program, i, maxLength, &length, &size, &type, buffer.data());
+
+		// Members of uniform blocks have no location
+		string name(buffer.data(), length);
+		GLint location = glGetUniformLocation(program, name.c_str());
+		if (location == INVALID_LOC)
+			continue;
+
+		AddUniform(name, location);
+
+		// Arrays are reported as "name[0]", every element can also be set on its own
+		size_t bracket = name.rfind("[0]");
+		if (bracket == string::npos || bracket + 3 != name.size())
+			continue;
+
+		string arrayName = name.substr(0, bracket);
+		AddUniform(arrayName, location);
+		for (GLint element = 1; element < size; element++)
+		{
+			string elementName = arrayName + "[" + to_string(element) + "]";
+			AddUniform(elementName, glGetUniformLocation(program, elementName.c_str()));
+		}
+	}
+}
+
+void Shader::AddUniform(const string &name, GLint location)
+{
+	Uniform uniform;
+	uniform.name = name;
+	uniform.location = location;
+	uniform.hasValue = false;
+	uniforms.push_back(uniform);
+
+	// On a hash collision the first name keeps the slot, the others are found by FindUniform
+	uniformIndices.insert(make_pair(HashName(name.c_str()), static_cast<int>(uniforms.size()) - 1));
+}
+
+int Shader::FindUniform(const char *uniformName) const
+{
+	auto it = uniformIndices.find(HashName(uniformName));
+	if (it == uniformIndices.end())
+		return -1;
+
+	if (uniforms[it->second].name == uniformName)
+		return it->second;
+
+	for (size_t i = 0; i < uniforms.size(); i++)
+	{
+		if (uniforms[i].name == uniformName)
+			return static_cast<int>(i);
+	}
+	return -1;
+}
+
+Shader::Uniform* Shader::GetChangedUniform(const char *uniformName, const void *value, size_t size)
+{
+	int index = FindUniform(uniformName);
+	if (index == -1)
+		return nullptr;
+
+	Uniform &uniform = uniforms[index];
+	if (uniform.hasValue && memcmp(uniform.value, value, size) == 0)
+		return nullptr;
+
+	memcpy(uniform.value, value, size);
+	uniform.hasValue = true;
+	return &uniform;
+}
+
+size_t Shader::HashName(const char *name)
+{
+	// FNV-1a, the names are short and hashed straight from the C string
+	size_t hash = 2166136261u;
+	for (; *name; name++)
+	{
+		hash ^= static_cast<unsigned char>(*name);
+		hash *= 16777619u;
+	}
+	return hash;
 }
 
 void Shader::OnLoad(function<void()> onLoad)
@@ -72,6 +218,9 @@ void Shader::GetUniforms()
 	loc_view_matrix		= GetUniformLocation("View");
 	loc_projection_matrix = GetUniformLocation("Projection");
 
+	// Instanced model matrix, looked up once so batching doesn't query the driver
+	loc_model_attribute = glGetAttribLocation(program, "v_model");
+
 	// Lighting and Shadow
 	loc_light_pos = GetUniformLocation("light_position");
 	loc_light_color = GetUniformLocation("light_color");
@@ -98,6 +247,11 @@ void Shader::GetUniforms()
 	// Text
 	text_color = GetUniformLocation("text_color");
 
+	// Shared camera matrices, View and Projection have no location when they come from the block
+	GLuint cameraBlock = glGetUniformBlockIndex(program, "Camera");
+	if (cameraBlock != GL_INVALID_INDEX)
+		glUniformBlockBinding(program, cameraBlock, CAMERA_UNIFORM_BINDING);
+
 	BindTexturesUnits();
 
 	CheckOpenGLError();
@@ -111,6 +265,21 @@ void Shader::AddShader(const string & shaderFile, GLenum shaderType)
 	shaderFiles.push_back(S);
 }
 
+void Shader::AddTessellationShaders(const string &controlShaderFile, const string &evaluationShaderFile,
+									int patchVertices)
+{
+	#ifndef OPENGL_ES
+	AddShader(controlShaderFile, GL_TESS_CONTROL_SHADER);
+	AddShader(evaluationShaderFile, GL_TESS_EVALUATION_SHADER);
+	this->patchVertices = patchVertices;
+	#endif
+}
+
+int Shader::GetPatchVertices() const
+{
+	return patchVertices;
+}
+
 unsigned int Shader::CreateAndLink()
 {
 	vector<unsigned int> shaders;
@@ -132,7 +301,8 @@ unsigned int Shader::CreateAndLink()
 
 		if (program)
 		{
-			glUseProgram(program);
+			RenderState::UseProgram(program);
+			IntrospectUniforms();
 			GetUniforms();
 			for (auto Observer : loadObservers) {
 				Observer();
@@ -146,6 +316,7 @@ unsigned int Shader::CreateAndLink()
 void Shader::ClearShaders()
 {
 	shaderFiles.clear();
+	patchVertices = 0;
 }
 
 unsigned int Shader::CreateShader(const string &shaderFile, GLenum shaderType)
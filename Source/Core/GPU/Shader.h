@@ -3,12 +3,17 @@
 #include <vector>
 #include <list>
 #include <functional>
+#include <unordered_map>
 
 #include <include/gl.h>
+#include <include/glm.h>
 
 #define MAX_2D_TEXTURES		16
 #define INVALID_LOC			-1
 
+// Binding point of the "Camera" uniform block, see CameraUniforms
+#define CAMERA_UNIFORM_BINDING	0
+
 class Shader
 {
 	public:
@@ -22,15 +27,54 @@ class Shader
 		unsigned int Reload();
 
 		void AddShader(const std::string &shaderFile, GLenum shaderType);
+
+		// Adds both tessellation stages, Use() also sets the number of vertices of each patch
+		void AddTessellationShaders(const std::string &controlShaderFile, const std::string &evaluationShaderFile,
+									int patchVertices);
+		int GetPatchVertices() const;
 		void ClearShaders();
 		unsigned int CreateAndLink();
 
 		void BindTexturesUnits();
+
+		// Looked up in the active uniforms found after linking, no driver call
 		GLint GetUniformLocation(const char * uniformName) const;
 
+		// Typed setters for the program in use, unknown uniforms are ignored
+		// The last value of each uniform is cached, sending the same value again is skipped
+		// A uniform also written with glUniform* directly may be left stale, use one or the other
+		void SetUniform(const char *uniformName, int value);
+		void SetUniform(const char *uniformName, float value);
+		void SetUniform(const char *uniformName, const glm::vec2 &value);
+		void SetUniform(const char *uniformName, const glm::vec3 &value);
+		void SetUniform(const char *uniformName, const glm::vec4 &value);
+		void SetUniform(const char *uniformName, const glm::ivec2 &value);
+		void SetUniform(const char *uniformName, const glm::mat4 &value);
+
 		void OnLoad(std::function<void()> onLoad);
 
 	private:
+		// Active uniform, array elements get an entry each
+		struct Uniform
+		{
+			std::string name;
+			GLint location;
+
+			// Last value sent by the setters, large enough for a 4x4 matrix
+			GLfloat value[16];
+			bool hasValue;
+		};
+
+		// Fills the uniform table with glGetActiveUniform, after every link
+		void IntrospectUniforms();
+		void AddUniform(const std::string &name, GLint location);
+		int FindUniform(const char *uniformName) const;
+
+		// Returns the uniform if the value differs from the cached one, the cache is updated
+		Uniform* GetChangedUniform(const char *uniformName, const void *value, size_t size);
+
+		static size_t HashName(const char *name);
+
 		void GetUniforms();
 		static unsigned int CreateShader(const std::string &shaderFile, GLenum shaderType);
 		static unsigned int CreateProgram(const std::vector<unsigned int> &shaderObjects);
@@ -45,6 +89,7 @@ class Shader
 		GLint loc_model_matrix;
 		GLint loc_view_matrix;
 		GLint loc_projection_matrix;
+		GLint loc_model_attribute;
 
 		// Shadow
 		GLint loc_light_pos;
@@ -76,5 +121,11 @@ class Shader
 
 		std::string shaderName;
 		std::vector<ShaderFile> shaderFiles;
+
+		// Uniforms indexed by the hash of their name
+		std::vector<Uniform> uniforms;
+		std::unordered_map<size_t, int> uniformIndices;
+
+		int patchVertices;
 		std::list<std::function<void()>> loadObservers;
 };
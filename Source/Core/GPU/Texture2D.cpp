@@ -5,6 +5,8 @@
 
 #include <include/gl.h>
 
+#include <Core/GPU/RenderState.h>
+
 using namespace std;
 
 #define STB_IMAGE_IMPLEMENTATION
@@ -83,7 +85,7 @@ bool Texture2D::Load2D(const char* fileName, GLenum wrapping_mode)
 	Init2DTexture(width, height, chn);
 	glTexImage2D(targetType, 0, internalFormat[0][chn], width, height, 0, pixelFormat[chn], GL_UNSIGNED_BYTE, imageData);
 	glGenerateMipmap(targetType);
-	glBindTexture(targetType, 0);
+	RenderState::BindTexture(targetType, 0);
 	CheckOpenGLError();
 
 	if (cacheInMemory == false)
@@ -100,7 +102,7 @@ void Texture2D::SaveToFile(const char * fileName)
 	{
 		imageData = new unsigned char[width * height * channels];
 	}
-	glBindTexture(targetType, textureID);
+	RenderState::BindTexture(targetType, textureID);
 	glGetTexImage(targetType, 0, pixelFormat[channels], GL_UNSIGNED_BYTE, (void*)imageData);
 
 	stbi_write_png(fileName, width, height, channels, imageData, width * channels);
@@ -147,10 +149,10 @@ void Texture2D::CreateCubeTexture(const float * data, uint width, uint height, u
 	this->height = height;
 	targetType = GL_TEXTURE_CUBE_MAP;
 
-	glDeleteTextures(1, &textureID);
+	RenderState::DeleteTextures(1, &textureID);
 	glGenTextures(1, &textureID);
 
-	glBindTexture(targetType, textureID);
+	RenderState::BindTexture(targetType, textureID);
 	glTexParameteri(targetType, GL_TEXTURE_MIN_FILTER, textureMinFilter);
 	glTexParameteri(targetType, GL_TEXTURE_MAG_FILTER, textureMagFilter);
 	glTexParameteri(targetType, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -170,7 +172,9 @@ void Texture2D::CreateCubeTexture(const float * data, uint width, uint height, u
 void Texture2D::CreateFrameBufferTexture(uint width, uint height, uint targetID, uint precision)
 {
 	bitsPerPixel = precision;
-	int prec = precision / 8 - 1;
+
+	// 16 bit targets are half floats, normalized ones would clamp the colors to 1
+	int prec = (precision == 16) ? 2 : precision / 8 - 1;
 	Init2DTexture(width, height, 4);
 	glTexImage2D(targetType, 0, internalFormat[prec][4], width, height, 0, pixelFormat[4], GL_UNSIGNED_BYTE, 0);
 	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + targetID, GL_TEXTURE_2D, textureID, 0);
@@ -187,19 +191,18 @@ void Texture2D::CreateDepthBufferTexture(uint width, uint height)
 
 void Texture2D::Bind() const
 {
-	glBindTexture(GL_TEXTURE_2D, textureID);
+	RenderState::BindTexture(GL_TEXTURE_2D, textureID);
 }
 
 void Texture2D::BindToTextureUnit(GLenum TextureUnit) const
 {
 	if (!textureID) return;
-	glActiveTexture(TextureUnit);
-	glBindTexture(GL_TEXTURE_2D, textureID);
+	RenderState::BindTextureUnit(TextureUnit - GL_TEXTURE0, GL_TEXTURE_2D, textureID);
 }
 
 void Texture2D::UnBind() const
 {
-	glBindTexture(targetType, 0);
+	RenderState::BindTexture(targetType, 0);
 	CheckOpenGLError();
 }
 
@@ -247,7 +250,7 @@ void Texture2D::SetWrappingMode(GLenum mode)
 
 	if (textureID)
 	{
-		glBindTexture(targetType, textureID);
+		RenderState::BindTexture(targetType, textureID);
 		glTexParameteri(targetType, GL_TEXTURE_WRAP_S, mode);
 		glTexParameteri(targetType, GL_TEXTURE_WRAP_T, mode);
 		glTexParameteri(targetType, GL_TEXTURE_WRAP_R, mode);
@@ -259,7 +262,7 @@ void Texture2D::SetFiltering(GLenum minFilter, GLenum magFilter)
 {
 	if (textureID)
 	{
-		glBindTexture(targetType, textureID);
+		RenderState::BindTexture(targetType, textureID);
 
 		if (textureMinFilter != minFilter) {
 			glTexParameteri(targetType, GL_TEXTURE_MIN_FILTER, minFilter);
@@ -282,9 +285,9 @@ void Texture2D::Init2DTexture(unsigned int width, unsigned int height, unsigned
 	this->channels = channels;
 
 	if (textureID)
-		glDeleteTextures(1, &textureID);
+		RenderState::DeleteTextures(1, &textureID);
 	glGenTextures(1, &textureID);
-	glBindTexture(targetType, textureID);
+	RenderState::BindTexture(targetType, textureID);
 	SetTextureParameters();
 	glPixelStorei(GL_PACK_ALIGNMENT, 1);
 	CheckOpenGLError();
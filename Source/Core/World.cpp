@@ -62,10 +62,21 @@ void World::LoopUpdate()
 	// OnInputUpdate will be called each frame, the other functions are called only if an event is registered
 	window->UpdateObservers();
 
-	// Frame processing
-	FrameStart();
-	Update(static_cast<float>(deltaTime));
-	FrameEnd();
+	// Frame processing, each part timed on the GPU while the profiler is on
+	GPUProfiler::BeginFrame();
+	{
+		GPUProfiler::Scope scope("FrameStart");
+		FrameStart();
+	}
+	{
+		GPUProfiler::Scope scope("Update");
+		Update(static_cast<float>(deltaTime));
+	}
+	{
+		GPUProfiler::Scope scope("FrameEnd");
+		FrameEnd();
+	}
+	GPUProfiler::EndFrame();
 
 	// Swap front and back buffers - image will be displayed to the screen
 	window->SwapBuffers();
@@ -111,7 +111,7 @@ void Laborator2::RenderMeshInstanced(Mesh *mesh, Shader *shader, const glm::mat4
 		return;
 
 	// render an object using the specified shader 
-	glUseProgram(shader->program);
+	RenderState::UseProgram(shader->program);
 
 	// Bind model matrix
 	GLint loc_model_matrix = glGetUniformLocation(shader->program, "Model");
@@ -128,7 +128,7 @@ void Laborator2::RenderMeshInstanced(Mesh *mesh, Shader *shader, const glm::mat4
 	glUniformMatrix4fv(loc_projection_matrix, 1, GL_FALSE, glm::value_ptr(projectionMatrix));
 
 	// Draw the object instanced
-	glBindVertexArray(mesh->GetBuffers()->VAO);
+	RenderState::BindVertexArray(mesh->GetBuffers()->VAO);
 	glDrawElementsInstanced(mesh->GetDrawMode(), static_cast<int>(mesh->indices.size()), GL_UNSIGNED_INT, (void*)0,instances);
 
 }
@@ -96,8 +96,7 @@ void Laborator4::Update(float deltaTimeSeconds)
 		glUniformMatrix4fv(shader->loc_view_matrix, 1, GL_FALSE, glm::value_ptr(camera->GetViewMatrix()));
 		glUniformMatrix4fv(shader->loc_projection_matrix, 1, GL_FALSE, glm::value_ptr(camera->GetProjectionMatrix()));
 
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_CUBE_MAP, cubeMapTextureID);
+		RenderState::BindTextureUnit(0, GL_TEXTURE_CUBE_MAP, cubeMapTextureID);
 		int loc_texture = shader->GetUniformLocation("texture_cubemap");
 		glUniform1i(loc_texture, 0);
 
@@ -117,8 +116,7 @@ void Laborator4::Update(float deltaTimeSeconds)
 
 		auto cameraPosition = camera->transform->GetWorldPosition();
 
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_CUBE_MAP, cubeMapTextureID);
+		RenderState::BindTextureUnit(0, GL_TEXTURE_CUBE_MAP, cubeMapTextureID);
 		int loc_texture = shader->GetUniformLocation("texture_cubemap");
 		glUniform1i(loc_texture, 0);
 
@@ -112,10 +112,10 @@ void Laborator5::Update(float deltaTimeSeconds)
 {
 	glLineWidth(3);
 
-	glEnable(GL_BLEND);
-	glDisable(GL_DEPTH_TEST);
-	glBlendFunc(GL_ONE, GL_ONE);
-	glBlendEquation(GL_FUNC_ADD);
+	RenderState::SetBlend(true);
+	RenderState::SetDepthTest(false);
+	RenderState::SetBlendFunc(GL_ONE, GL_ONE);
+	RenderState::SetBlendEquation(GL_FUNC_ADD);
 
 	{
 		auto shader = shaders["Particle"];
@@ -127,8 +127,8 @@ void Laborator5::Update(float deltaTimeSeconds)
 		}
 	}
 
-	glEnable(GL_DEPTH_TEST);
-	glDisable(GL_BLEND);
+	RenderState::SetDepthTest(true);
+	RenderState::SetBlend(false);
 
 	{
 		glm::mat4 model = glm::translate(glm::mat4(1), glm::vec3(3, 0, 0));
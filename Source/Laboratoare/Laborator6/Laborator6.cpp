@@ -129,9 +129,9 @@ void Laborator6::Update(float deltaTimeSeconds)
 
 		// Enable buffer color accumulation
 		glDepthMask(GL_FALSE);
-		glEnable(GL_BLEND);
-		glBlendEquation(GL_FUNC_ADD);
-		glBlendFunc(GL_ONE, GL_ONE);
+		RenderState::SetBlend(true);
+		RenderState::SetBlendEquation(GL_FUNC_ADD);
+		RenderState::SetBlendFunc(GL_ONE, GL_ONE);
 
 		auto shader = shaders["LightPass"];
 		shader->Use();
@@ -181,7 +181,7 @@ void Laborator6::Update(float deltaTimeSeconds)
 		glDisable(GL_CULL_FACE);
 
 		glDepthMask(GL_TRUE);
-		glDisable(GL_BLEND);
+		RenderState::SetBlend(false);
 	}
 
 	// ------------------------------------------------------------------------
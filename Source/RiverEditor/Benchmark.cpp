@@ -0,0 +1,251 @@
+#include "Benchmark.h"
+#include "BezierCurve.h"
+#include "PointGrid.h"
+#include "Spline.h"
+#include "RiverBatch.h"
+#include "WorkStealingPool.h"
+
+#include <chrono>
+#include <random>
+#include <limits>
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include <iostream>
+
+using namespace std;
+
+namespace
+{
+	typedef chrono::high_resolution_clock Clock;
+
+	// Reference implementation, the way the editor evaluated the curve before the batched version
+	glm::vec3 GetBernsteinPoint(const vector<glm::vec3> &controlPoints, float t)
+	{
+		int controlPointsCount = static_cast<int>(controlPoints.size());
+		glm::vec3 result = glm::vec3(0);
+		float c = 1;
+		for (int i = 0; i < controlPointsCount; i++)
+		{
+			if (i > 0)
+				c *= (controlPointsCount - i) / float(i);
+			result += c * powf((1 - t), float(controlPointsCount - 1 - i)) * powf(t, float(i)) * controlPoints[i];
+		}
+		return result;
+	}
+
+	// Reference implementation, nearest point found by checking all of them
+	int FindNearestLinear(const vector<glm::vec3> &points, const glm::vec3 &position, float radius)
+	{
+		int nearest = -1;
+		float nearestDistance = radius;
+		for (int i = 0; i < static_cast<int>(points.size()); i++)
+		{
+			float distance = glm::length(position - points[i]);
+			if (distance < nearestDistance)
+			{
+				nearestDistance = distance;
+				nearest = i;
+			}
+		}
+		return nearest;
+	}
+
+	double SamplesPerSecond(unsigned int samples, Clock::time_point start, Clock::time_point end)
+	{
+		double seconds = chrono::duration<double>(end - start).count();
+		return seconds > 0.0 ? samples / seconds : 0.0;
+	}
+}
+
+namespace Benchmark
+{
+	void BezierEvaluation(const BezierCurve &curve, unsigned int samples)
+	{
+		vector<float> parameters(samples);
+		for (unsigned int i = 0; i < samples; i++)
+			parameters[i] = i / float(samples - 1);
+
+		vector<glm::vec3> points(samples);
+		vector<glm::vec3> tangents(samples);
+		vector<glm::vec3> normals(samples);
+
+		// Keeps the compiler from removing the reference loop
+		glm::vec3 checksum(0);
+
+		auto start = Clock::now();
+		for (unsigned int i = 0; i < samples; i++)
+			points[i] = GetBernsteinPoint(curve.GetControlPoints(), parameters[i]);
+		auto end = Clock::now();
+		double bernstein = SamplesPerSecond(samples, start, end);
+		checksum += points[samples / 2];
+
+		start = Clock::now();
+		curve.Evaluate(parameters.data(), samples, points.data());
+		end = Clock::now();
+		double batched = SamplesPerSecond(samples, start, end);
+		checksum += points[samples / 2];
+
+		start = Clock::now();
+		curve.Evaluate(parameters.data(), samples, points.data(), tangents.data(), normals.data());
+		end = Clock::now();
+		double batchedFrames = SamplesPerSecond(samples, start, end);
+		checksum += normals[samples / 2];
+
+		cout << "Bezier evaluation, degree " << curve.GetDegree() << ", " << samples << " samples" << endl;
+		cout << "\tBernstein form: " << bernstein << " samples/sec" << endl;
+		cout << "\tde Casteljau (" << BezierCurve::GetSIMDName() << " x" << BezierCurve::GetSIMDWidth() << "): "
+			<< batched << " samples/sec, " << batched / bernstein << "x faster" << endl;
+		cout << "\tde Casteljau with tangents and normals: " << batchedFrames << " samples/sec" << endl;
+		cout << "\tchecksum " << checksum << endl;
+	}
+
+	void ControlPointPicking(unsigned int pointsCount, unsigned int queries)
+	{
+		// About one point for each unit of area, the density of a long river
+		float side = sqrt(float(pointsCount));
+		float radius = 0.4f;
+
+		mt19937 generator(42);
+		uniform_real_distribution<float> coordinate(0.0f, side);
+
+		vector<glm::vec3> points(pointsCount);
+		for (auto &point : points)
+			point = glm::vec3(coordinate(generator), coordinate(generator), 0.0f);
+
+		vector<glm::vec3> positions(queries);
+		for (auto &position : positions)
+			position = glm::vec3(coordinate(generator), coordinate(generator), 0.0f);
+
+		auto start = Clock::now();
+		PointGrid grid;
+		grid.Build(points);
+		auto end = Clock::now();
+		double buildMs = chrono::duration<double, milli>(end - start).count();
+
+		// Both versions must pick the same points
+		long long linearChecksum = 0;
+		long long gridChecksum = 0;
+
+		start = Clock::now();
+		for (auto &position : positions)
+			linearChecksum += FindNearestLinear(points, position, radius);
+		end = Clock::now();
+		double linear = SamplesPerSecond(queries, start, end);
+
+		start = Clock::now();
+		for (auto &position : positions)
+			gridChecksum += grid.FindNearest(position, radius);
+		end = Clock::now();
+		double indexed = SamplesPerSecond(queries, start, end);
+
+		// Dragging a point moves it a little every frame
+		start = Clock::now();
+		for (unsigned int i = 0; i < queries; i++)
+			grid.Move(i % pointsCount, points[i % pointsCount] + glm::vec3(0.01f * (i % 7), 0.0f, 0.0f));
+		end = Clock::now();
+		double moves = SamplesPerSecond(queries, start, end);
+
+		cout << "Control point picking, " << pointsCount << " points, " << queries << " queries" << endl;
+		cout << "	Linear scan: " << linear << " queries/sec" << endl;
+		cout << "	Grid: " << indexed << " queries/sec, " << indexed / linear << "x faster, built in " << buildMs << " ms" << endl;
+		cout << "	Grid moves: " << moves << " moves/sec" << endl;
+		cout << "	results " << (linearChecksum == gridChecksum ? "match" : "DIFFER") << endl;
+	}
+
+	void NearestPointOnRiver(const Spline &spline, unsigned int queries)
+	{
+		int segmentCount = spline.GetSegmentCount();
+		if (segmentCount == 0)
+			return;
+
+		// Brute force samples the whole river once, the way it would have been done before
+		const unsigned int samplesPerSegment = 64;
+		unsigned int samplesCount = samplesPerSegment * segmentCount;
+		vector<float> parameters(samplesCount);
+		for (unsigned int i = 0; i < samplesCount; i++)
+			parameters[i] = i / float(samplesCount - 1);
+		vector<glm::vec3> samples(samplesCount);
+
+		// Queries are taken close to the river
+		mt19937 generator(42);
+		uniform_real_distribution<float> parameter(0.0f, 1.0f);
+		uniform_real_distribution<float> offset(-0.5f, 0.5f);
+		vector<glm::vec3> positions(queries);
+		for (auto &position : positions)
+		{
+			float t = parameter(generator);
+			spline.Evaluate(&t, 1, &position);
+			position += glm::vec3(offset(generator), offset(generator), 0.0f);
+		}
+
+		// The first query also builds the tree
+		auto start = Clock::now();
+		spline.FindNearestPoint(positions[0], 1.0f);
+		auto end = Clock::now();
+		double buildMs = chrono::duration<double, milli>(end - start).count();
+
+		double bruteError = 0.0;
+		start = Clock::now();
+		for (auto &position : positions)
+		{
+			spline.Evaluate(parameters.data(), samplesCount, samples.data());
+			float nearest = numeric_limits<float>::max();
+			for (auto &sample : samples)
+				nearest = min(nearest, glm::length(sample - position));
+			bruteError += nearest;
+		}
+		end = Clock::now();
+		double brute = SamplesPerSecond(queries, start, end);
+
+		double treeError = 0.0;
+		start = Clock::now();
+		for (auto &position : positions)
+			treeError += spline.FindNearestPoint(position, 1.0f).distance;
+		end = Clock::now();
+		double tree = SamplesPerSecond(queries, start, end);
+
+		cout << "Nearest point on river, " << segmentCount << " segments, " << queries << " queries" << endl;
+		cout << "\tSampling " << samplesPerSegment << " points per segment: " << brute << " queries/sec" << endl;
+		cout << "\tSegment tree: " << tree << " queries/sec, " << 1e6 / tree << " us per query, built in " << buildMs << " ms" << endl;
+		cout << "\tmean distance, sampling " << bruteError / queries << ", tree " << treeError / queries << endl;
+	}
+
+	void BatchTessellation(const vector<const Spline*> &rivers, int pointsPerSegment)
+	{
+		RiverMeshSettings settings;
+		settings.mode = TESSELLATION_UNIFORM;
+		settings.pointsCount = pointsPerSegment;
+
+		RiverBatch batch;
+		batch.SetRivers(rivers);
+
+		cout << "Batch tessellation, " << rivers.size() << " rivers, " << pointsPerSegment << " points per segment" << endl;
+
+		double singleThread = 0.0;
+		unsigned int hardwareThreads = max(thread::hardware_concurrency(), 1u);
+		for (unsigned int workers = 1; ; workers = min(2 * workers, hardwareThreads))
+		{
+			WorkStealingPool pool(workers);
+
+			// The first run allocates the arena and the scratch memory
+			batch.Tessellate(pool, settings);
+
+			const int runs = 5;
+			auto start = Clock::now();
+			for (int i = 0; i < runs; i++)
+				batch.Tessellate(pool, settings);
+			auto end = Clock::now();
+
+			double ms = chrono::duration<double, milli>(end - start).count() / runs;
+			if (workers == 1)
+				singleThread = ms;
+
+			cout << "\t" << workers << " workers: " << ms << " ms, " << batch.GetVertexCount() << " vertices, "
+				<< singleThread / ms << "x speedup" << endl;
+
+			if (workers == hardwareThreads)
+				break;
+		}
+	}
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <vector>
+
+class BezierCurve;
+class Spline;
+
+// Microbenchmarks for the river editor hot paths, results are printed to the console
+namespace Benchmark
+{
+	// Compares the batched curve evaluation against the Bernstein form used before
+	void BezierEvaluation(const BezierCurve &curve, unsigned int samples);
+
+	// Compares the linear scan used for picking against the grid index, on random points
+	void ControlPointPicking(unsigned int pointsCount, unsigned int queries);
+
+	// Compares sampling every segment against the segment tree, for queries around the river
+	void NearestPointOnRiver(const Spline &spline, unsigned int queries);
+
+	// Tessellates the same batch of rivers with 1, 2, 4 ... workers, up to the hardware threads
+	void BatchTessellation(const std::vector<const Spline*> &rivers, int pointsPerSegment);
+}
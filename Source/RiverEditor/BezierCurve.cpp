@@ -0,0 +1,311 @@
+#include "BezierCurve.h"
+
+#include <algorithm>
+
+#if defined(__AVX__)
+	#include <immintrin.h>
+	#define BEZIER_SIMD_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define BEZIER_SIMD_SSE
+#endif
+
+namespace
+{
+	// Minimal wrapper over the SIMD registers, so the evaluation is written only once
+#if defined(BEZIER_SIMD_AVX)
+	struct Lanes
+	{
+		typedef __m256 Type;
+		static const int size = 8;
+
+		static Type Load(const float *p)			{ return _mm256_loadu_ps(p); }
+		static void Store(float *p, Type v)			{ _mm256_storeu_ps(p, v); }
+		static Type Set(float v)					{ return _mm256_set1_ps(v); }
+		static Type Add(Type a, Type b)				{ return _mm256_add_ps(a, b); }
+		static Type Sub(Type a, Type b)				{ return _mm256_sub_ps(a, b); }
+		static Type Mul(Type a, Type b)				{ return _mm256_mul_ps(a, b); }
+		static Type Max(Type a, Type b)				{ return _mm256_max_ps(a, b); }
+		static Type Sqrt(Type a)					{ return _mm256_sqrt_ps(a); }
+		static Type Div(Type a, Type b)				{ return _mm256_div_ps(a, b); }
+	};
+#elif defined(BEZIER_SIMD_SSE)
+	struct Lanes
+	{
+		typedef __m128 Type;
+		static const int size = 4;
+
+		static Type Load(const float *p)			{ return _mm_loadu_ps(p); }
+		static void Store(float *p, Type v)			{ _mm_storeu_ps(p, v); }
+		static Type Set(float v)					{ return _mm_set1_ps(v); }
+		static Type Add(Type a, Type b)				{ return _mm_add_ps(a, b); }
+		static Type Sub(Type a, Type b)				{ return _mm_sub_ps(a, b); }
+		static Type Mul(Type a, Type b)				{ return _mm_mul_ps(a, b); }
+		static Type Max(Type a, Type b)				{ return _mm_max_ps(a, b); }
+		static Type Sqrt(Type a)					{ return _mm_sqrt_ps(a); }
+		static Type Div(Type a, Type b)				{ return _mm_div_ps(a, b); }
+	};
+#endif
+
+	glm::vec3 CurveNormal(const glm::vec3 &tangent)
+	{
+		float length = glm::length(glm::vec2(tangent));
+		if (length < 1e-6f)
+			return glm::vec3(0.0f);
+
+		return glm::vec3(tangent.y, -tangent.x, 0.0f) / length;
+	}
+}
+
+BezierCurve::BezierCurve(const std::vector<glm::vec3> &controlPoints)
+{
+	SetControlPoints(controlPoints);
+}
+
+void BezierCurve::SetControlPoints(const std::vector<glm::vec3> &controlPoints)
+{
+	this->controlPoints = controlPoints;
+
+	xs.resize(controlPoints.size());
+	ys.resize(controlPoints.size());
+	zs.resize(controlPoints.size());
+	for (size_t i = 0; i < controlPoints.size(); i++)
+	{
+		SetControlPoint(static_cast<int>(i), controlPoints[i]);
+	}
+}
+
+void BezierCurve::SetControlPoint(int index, const glm::vec3 &point)
+{
+	controlPoints[index] = point;
+	xs[index] = point.x;
+	ys[index] = point.y;
+	zs[index] = point.z;
+}
+
+const std::vector<glm::vec3>& BezierCurve::GetControlPoints() const
+{
+	return controlPoints;
+}
+
+int BezierCurve::GetControlPointsCount() const
+{
+	return static_cast<int>(controlPoints.size());
+}
+
+int BezierCurve::GetDegree() const
+{
+	return static_cast<int>(controlPoints.size()) - 1;
+}
+
+glm::vec3 BezierCurve::GetPoint(float t) const
+{
+	glm::vec3 point, tangent;
+	EvaluateScalar(t, point, tangent);
+	return point;
+}
+
+void BezierCurve::EvaluateScalar(float t, glm::vec3 &point, glm::vec3 &tangent) const
+{
+	int n = GetControlPointsCount();
+	point = tangent = glm::vec3(0);
+	if (n == 0)
+		return;
+
+	// Small curves don't need heap memory
+	glm::vec3 stackPoints[8];
+	std::vector<glm::vec3> heapPoints;
+	glm::vec3 *b = stackPoints;
+	if (n > 8)
+	{
+		heapPoints.resize(n);
+		b = heapPoints.data();
+	}
+	std::copy(controlPoints.begin(), controlPoints.end(), b);
+
+	// Reduce the control polygon until the last two points are left
+	for (int level = n - 1; level > 1; level--)
+	{
+		for (int i = 0; i < level; i++)
+			b[i] += (b[i + 1] - b[i]) * t;
+	}
+
+	if (n == 1)
+	{
+		point = b[0];
+		return;
+	}
+
+	// The last segment of the reduction is parallel to the tangent
+	tangent = float(n - 1) * (b[1] - b[0]);
+	point = b[0] + (b[1] - b[0]) * t;
+}
+
+void BezierCurve::Evaluate(const float *t, unsigned int count, glm::vec3 *points,
+							glm::vec3 *tangents, glm::vec3 *normals) const
+{
+	unsigned int i = 0;
+	int n = GetControlPointsCount();
+
+#if defined(BEZIER_SIMD_AVX) || defined(BEZIER_SIMD_SSE)
+	typedef Lanes::Type Lane;
+	const int L = Lanes::size;
+
+	if (n > 1 && count >= static_cast<unsigned int>(L))
+	{
+		// One row of lanes for each control point and coordinate
+		std::vector<float> scratch(3 * n * L);
+		float *bx = scratch.data();
+		float *by = bx + n * L;
+		float *bz = by + n * L;
+
+		float px[L], py[L], pz[L];
+		float tx[L], ty[L], tz[L];
+		float nx[L], ny[L];
+
+		const Lane degree = Lanes::Set(float(n - 1));
+		const Lane epsilon = Lanes::Set(1e-12f);
+
+		for (; i + L <= count; i += L)
+		{
+			Lane lt = Lanes::Load(t + i);
+
+			// The first reduction reads directly from the control points
+			for (int k = 0; k < n - 1; k++)
+			{
+				Lane x0 = Lanes::Set(xs[k]), x1 = Lanes::Set(xs[k + 1]);
+				Lane y0 = Lanes::Set(ys[k]), y1 = Lanes::Set(ys[k + 1]);
+				Lane z0 = Lanes::Set(zs[k]), z1 = Lanes::Set(zs[k + 1]);
+				Lanes::Store(bx + k * L, Lanes::Add(x0, Lanes::Mul(Lanes::Sub(x1, x0), lt)));
+				Lanes::Store(by + k * L, Lanes::Add(y0, Lanes::Mul(Lanes::Sub(y1, y0), lt)));
+				Lanes::Store(bz + k * L, Lanes::Add(z0, Lanes::Mul(Lanes::Sub(z1, z0), lt)));
+			}
+
+			// Remaining reductions, stop when a single segment is left
+			for (int remaining = n - 1; remaining > 2; remaining--)
+			{
+				for (int k = 0; k < remaining - 1; k++)
+				{
+					Lane x0 = Lanes::Load(bx + k * L), x1 = Lanes::Load(bx + (k + 1) * L);
+					Lane y0 = Lanes::Load(by + k * L), y1 = Lanes::Load(by + (k + 1) * L);
+					Lane z0 = Lanes::Load(bz + k * L), z1 = Lanes::Load(bz + (k + 1) * L);
+					Lanes::Store(bx + k * L, Lanes::Add(x0, Lanes::Mul(Lanes::Sub(x1, x0), lt)));
+					Lanes::Store(by + k * L, Lanes::Add(y0, Lanes::Mul(Lanes::Sub(y1, y0), lt)));
+					Lanes::Store(bz + k * L, Lanes::Add(z0, Lanes::Mul(Lanes::Sub(z1, z0), lt)));
+				}
+			}
+
+			// For n == 2 the first reduction already produced the point
+			Lane x, y, z, dx, dy, dz;
+			if (n == 2)
+			{
+				x = Lanes::Load(bx);
+				y = Lanes::Load(by);
+				z = Lanes::Load(bz);
+				dx = Lanes::Set(xs[1] - xs[0]);
+				dy = Lanes::Set(ys[1] - ys[0]);
+				dz = Lanes::Set(zs[1] - zs[0]);
+			}
+			else
+			{
+				// Last reduction was kept in bx[0..1], finish it here and keep the difference
+				Lane x0 = Lanes::Load(bx), x1 = Lanes::Load(bx + L);
+				Lane y0 = Lanes::Load(by), y1 = Lanes::Load(by + L);
+				Lane z0 = Lanes::Load(bz), z1 = Lanes::Load(bz + L);
+				dx = Lanes::Sub(x1, x0);
+				dy = Lanes::Sub(y1, y0);
+				dz = Lanes::Sub(z1, z0);
+				x = Lanes::Add(x0, Lanes::Mul(dx, lt));
+				y = Lanes::Add(y0, Lanes::Mul(dy, lt));
+				z = Lanes::Add(z0, Lanes::Mul(dz, lt));
+			}
+
+			Lanes::Store(px, x);
+			Lanes::Store(py, y);
+			Lanes::Store(pz, z);
+			for (int l = 0; l < L; l++)
+				points[i + l] = glm::vec3(px[l], py[l], pz[l]);
+
+			if (!tangents && !normals)
+				continue;
+
+			dx = Lanes::Mul(dx, degree);
+			dy = Lanes::Mul(dy, degree);
+			dz = Lanes::Mul(dz, degree);
+
+			if (tangents)
+			{
+				Lanes::Store(tx, dx);
+				Lanes::Store(ty, dy);
+				Lanes::Store(tz, dz);
+				for (int l = 0; l < L; l++)
+					tangents[i + l] = glm::vec3(tx[l], ty[l], tz[l]);
+			}
+
+			if (normals)
+			{
+				// Normal in the XoY plane, degenerate tangents end up with a null normal
+				Lane length = Lanes::Sqrt(Lanes::Max(Lanes::Add(Lanes::Mul(dx, dx), Lanes::Mul(dy, dy)), epsilon));
+				Lanes::Store(nx, Lanes::Div(dy, length));
+				Lanes::Store(ny, Lanes::Div(Lanes::Sub(Lanes::Set(0.0f), dx), length));
+				for (int l = 0; l < L; l++)
+					normals[i + l] = glm::vec3(nx[l], ny[l], 0.0f);
+			}
+		}
+	}
+#endif
+
+	// Scalar tail, or the whole batch when SIMD is not available
+	for (; i < count; i++)
+	{
+		glm::vec3 tangent;
+		EvaluateScalar(t[i], points[i], tangent);
+		if (tangents)
+			tangents[i] = tangent;
+		if (normals)
+			normals[i] = CurveNormal(tangent);
+	}
+}
+
+int BezierCurve::EstimateSegmentCount(float tolerance, const glm::mat4 &transform) const
+{
+	int n = GetControlPointsCount();
+	if (n < 3)
+		return 1;
+
+	// Largest second difference of the transformed control polygon
+	float secondDifference = 0.0f;
+	glm::vec2 p0 = glm::vec2(transform * glm::vec4(controlPoints[0], 1.0f));
+	glm::vec2 p1 = glm::vec2(transform * glm::vec4(controlPoints[1], 1.0f));
+	for (int i = 2; i < n; i++)
+	{
+		glm::vec2 p2 = glm::vec2(transform * glm::vec4(controlPoints[i], 1.0f));
+		secondDifference = std::max(secondDifference, glm::length(p0 - 2.0f * p1 + p2));
+		p0 = p1;
+		p1 = p2;
+	}
+
+	int degree = n - 1;
+	float segments = ceil(sqrt(degree * (degree - 1) / 8.0f * secondDifference / tolerance));
+	return std::max(static_cast<int>(segments), 1);
+}
+
+const char* BezierCurve::GetSIMDName()
+{
+#if defined(BEZIER_SIMD_AVX)
+	return "AVX";
+#elif defined(BEZIER_SIMD_SSE)
+	return "SSE";
+#else
+	return "scalar";
+#endif
+}
+
+int BezierCurve::GetSIMDWidth()
+{
+#if defined(BEZIER_SIMD_AVX) || defined(BEZIER_SIMD_SSE)
+	return Lanes::size;
+#else
+	return 1;
+#endif
+}
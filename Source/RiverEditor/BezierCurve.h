@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+
+#include <include/glm.h>
+
+// Bezier curve of any degree, evaluated with de Casteljau's algorithm.
+// Batched evaluation processes several parameters at once on SIMD lanes (SSE/AVX).
+class BezierCurve
+{
+public:
+	BezierCurve() {}
+	BezierCurve(const std::vector<glm::vec3> &controlPoints);
+
+	void SetControlPoints(const std::vector<glm::vec3> &controlPoints);
+	void SetControlPoint(int index, const glm::vec3 &point);
+	const std::vector<glm::vec3>& GetControlPoints() const;
+
+	int GetControlPointsCount() const;
+	int GetDegree() const;
+
+	// Returns a single point on the curve
+	glm::vec3 GetPoint(float t) const;
+
+	// Evaluates the curve for count parameters at once
+	// Tangents and normals are optional, pass nullptr to skip them
+	// Normals lie in the XoY plane, the same way the river geometry shader builds them
+	void Evaluate(const float *t, unsigned int count, glm::vec3 *points,
+					glm::vec3 *tangents = nullptr, glm::vec3 *normals = nullptr) const;
+
+	// Wang's formula: number of segments so that a polyline through uniformly spaced
+	// parameters stays within tolerance of the curve, measured after the transform
+	// The transform is assumed affine (e.g. an orthographic projection to pixels)
+	int EstimateSegmentCount(float tolerance, const glm::mat4 &transform) const;
+
+	// Name of the instruction set used by the batched evaluation
+	static const char* GetSIMDName();
+
+	// Number of parameters evaluated in a single SIMD batch
+	static int GetSIMDWidth();
+
+private:
+	void EvaluateScalar(float t, glm::vec3 &point, glm::vec3 &tangent) const;
+
+private:
+	std::vector<glm::vec3> controlPoints;
+
+	// Structure of arrays copy of the control points, used by the SIMD lanes
+	std::vector<float> xs;
+	std::vector<float> ys;
+	std::vector<float> zs;
+};
@@ -0,0 +1,100 @@
+#include "BloomChain.h"
+
+#include <algorithm>
+
+#include <include/utils.h>
+#include <Core/GPU/FrameBuffer.h>
+#include <Core/GPU/Mesh.h>
+#include <Core/GPU/Shader.h>
+#include <Core/GPU/Texture2D.h>
+#include <Core/GPU/RenderState.h>
+
+BloomChain::BloomChain()
+{
+}
+
+BloomChain::~BloomChain()
+{
+	for (auto &level : levels)
+		level->Clean();
+}
+
+void BloomChain::Generate(const glm::ivec2 &resolution, int levelsCount)
+{
+	for (auto &level : levels)
+		level->Clean();
+	levels.clear();
+
+	glm::ivec2 size = resolution;
+	for (int i = 0; i < levelsCount; i++)
+	{
+		size = glm::max(size / 2, glm::ivec2(1));
+
+		// Half floats keep the bright values above 1, the levels are never read past their edges
+		FrameBuffer *level = new FrameBuffer();
+		level->Generate(size.x, size.y, 1, false, 16);
+		level->GetTexture(0)->SetWrappingMode(GL_CLAMP_TO_EDGE);
+		levels.push_back(std::unique_ptr<FrameBuffer>(level));
+	}
+}
+
+Texture2D* BloomChain::Apply(Texture2D *source, Mesh *quad, Shader *downsample, Shader *upsample,
+							 float threshold, int levelsCount, bool accumulate)
+{
+	levelsCount = std::min(levelsCount, static_cast<int>(levels.size()));
+	if (levelsCount <= 0 || !source || !quad || !downsample->program || !upsample->program)
+		return nullptr;
+
+	RenderState::SetBlend(false);
+	RenderState::SetDepthTest(false);
+
+	// Only the first pass extracts the bright texels
+	downsample->Use();
+	downsample->SetUniform("threshold", threshold);
+	DrawPass(levels[0].get(), source, quad, downsample);
+
+	downsample->SetUniform("threshold", 0.0f);
+	for (int i = 1; i < levelsCount; i++)
+		DrawPass(levels[i].get(), levels[i - 1]->GetTexture(0), quad, downsample);
+
+	// The larger level still holds its downsampled texels, accumulating adds the upsampled ones over them
+	if (accumulate)
+	{
+		RenderState::SetBlend(true);
+		RenderState::SetBlendFunc(GL_ONE, GL_ONE);
+		RenderState::SetBlendEquation(GL_FUNC_ADD);
+	}
+
+	upsample->Use();
+	for (int i = levelsCount - 1; i > 0; i--)
+		DrawPass(levels[i - 1].get(), levels[i]->GetTexture(0), quad, upsample);
+
+	RenderState::SetBlend(false);
+	RenderState::SetDepthTest(true);
+
+	// The levels are sampled by the next pass, none of them can stay bound as a target
+	FrameBuffer::BindDefault();
+	CheckOpenGLError();
+
+	return levels[0]->GetTexture(0);
+}
+
+int BloomChain::GetLevelsCount() const
+{
+	return static_cast<int>(levels.size());
+}
+
+void BloomChain::DrawPass(FrameBuffer *target, Texture2D *source, Mesh *quad, Shader *shader)
+{
+	// Every texel is written, nothing to clear
+	target->Bind(false);
+
+	glm::vec2 texelSize = 1.0f / glm::vec2(source->GetWidth(), source->GetHeight());
+	shader->SetUniform("texel_size", texelSize);
+
+	quad->UseMaterials(false);
+	source->BindToTextureUnit(GL_TEXTURE0);
+	glUniform1i(shader->loc_textures[0], 0);
+
+	quad->Render();
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+
+#include <include/glm.h>
+
+class FrameBuffer;
+class Mesh;
+class Shader;
+class Texture2D;
+
+// Wide blur of a frame, built from half resolution targets instead of a full resolution kernel.
+// The frame is downsampled down the chain by BloomDown.FS.glsl, each level half the size of the
+// previous one, then upsampled back to the first level by BloomUp.FS.glsl (dual filtering).
+// Every pass is drawn with Screen.VS.glsl on the quad mesh.
+class BloomChain
+{
+public:
+	BloomChain();
+	~BloomChain();
+
+	// The first level is half the resolution of the frame
+	void Generate(const glm::ivec2 &resolution, int levelsCount);
+
+	// Runs the source through the first levelsCount levels, returns the first one.
+	// Texels darker than the threshold are left out, 0 keeps them all.
+	// Accumulated levels are added over each other on the way up, for a bloom with a sharp core
+	// and wide tails, otherwise each level replaces the next one and the result is a plain blur.
+	Texture2D* Apply(Texture2D *source, Mesh *quad, Shader *downsample, Shader *upsample,
+					 float threshold, int levelsCount, bool accumulate);
+
+	int GetLevelsCount() const;
+
+private:
+	void DrawPass(FrameBuffer *target, Texture2D *source, Mesh *quad, Shader *shader);
+
+private:
+	std::vector< std::unique_ptr<FrameBuffer> > levels;
+};
@@ -0,0 +1,157 @@
+#include "ComputeBlur.h"
+
+#include <cmath>
+#include <algorithm>
+
+#include <include/utils.h>
+#include <Core/GPU/Shader.h>
+#include <Core/GPU/Texture2D.h>
+
+ComputeBlur::ComputeBlur()
+{
+	resolution = glm::ivec2(0);
+	next = 0;
+}
+
+ComputeBlur::~ComputeBlur()
+{
+	targets.Clean();
+}
+
+void ComputeBlur::Generate(const glm::ivec2 &resolution)
+{
+	this->resolution = resolution;
+
+	// Written as images, never drawn into
+	targets.Generate(resolution.x, resolution.y, 2, false, 16);
+	for (int i = 0; i < 2; i++)
+		targets.GetTexture(i)->SetWrappingMode(GL_CLAMP_TO_EDGE);
+}
+
+Texture2D* ComputeBlur::Apply(Texture2D *source, Shader *boxBlur, Shader *kawaseBlur, BlurKernel kernel, int radius)
+{
+	if (!source || resolution.x == 0)
+		return source;
+
+	radius = glm::clamp(radius, 0, MAX_RADIUS);
+
+	// The result of the last blur may be blurred again, it can't be the first target written
+	next = (source == targets.GetTexture(0)) ? 1 : 0;
+
+	Texture2D *result = source;
+	switch (kernel)
+	{
+	case BLUR_KERNEL_BOX:
+		result = BoxPass(result, boxBlur, glm::ivec2(1, 0), radius);
+		result = BoxPass(result, boxBlur, glm::ivec2(0, 1), radius);
+		break;
+
+	case BLUR_KERNEL_GAUSSIAN:
+	{
+		int boxes[3];
+		GetGaussianBoxes(radius, boxes);
+		for (int i = 0; i < 3; i++)
+			result = BoxPass(result, boxBlur, glm::ivec2(1, 0), boxes[i]);
+		for (int i = 0; i < 3; i++)
+			result = BoxPass(result, boxBlur, glm::ivec2(0, 1), boxes[i]);
+		break;
+	}
+
+	case BLUR_KERNEL_KAWASE:
+	{
+		// Pass i spreads the texels by i + 1 more, until the radius is covered
+		for (int offset = 0, reach = 0; reach < radius; offset++)
+		{
+			result = KawasePass(result, kawaseBlur, offset);
+			reach += offset + 1;
+		}
+		break;
+	}
+
+	default:
+		break;
+	}
+
+	CheckOpenGLError();
+	return result;
+}
+
+const char* ComputeBlur::GetKernelName(BlurKernel kernel)
+{
+	switch (kernel)
+	{
+	case BLUR_KERNEL_BOX:
+		return "box";
+	case BLUR_KERNEL_GAUSSIAN:
+		return "gaussian";
+	case BLUR_KERNEL_KAWASE:
+		return "kawase";
+	default:
+		return "unknown";
+	}
+}
+
+Texture2D* ComputeBlur::BoxPass(Texture2D *source, Shader *shader, const glm::ivec2 &direction, int radius)
+{
+	if (radius <= 0 || !shader || !shader->program)
+		return source;
+
+	Texture2D *target = targets.GetTexture(next);
+	next = 1 - next;
+
+	shader->Use();
+	shader->SetUniform("radius", radius);
+	shader->SetUniform("direction", direction);
+
+	source->BindToTextureUnit(GL_TEXTURE0);
+	glUniform1i(shader->loc_textures[0], 0);
+	glBindImageTexture(0, target->GetTextureID(), 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+
+	// A row of work groups for each line, a work group for each tile of it
+	int lineLength = direction.x ? resolution.x : resolution.y;
+	int lines = direction.x ? resolution.y : resolution.x;
+	glDispatchCompute((lineLength + TILE_SIZE - 1) / TILE_SIZE, lines, 1);
+
+	// The next pass samples what this one wrote, and may write what this one sampled
+	glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+	return target;
+}
+
+Texture2D* ComputeBlur::KawasePass(Texture2D *source, Shader *shader, int offset)
+{
+	if (!shader || !shader->program)
+		return source;
+
+	Texture2D *target = targets.GetTexture(next);
+	next = 1 - next;
+
+	shader->Use();
+	shader->SetUniform("offset", static_cast<float>(offset));
+
+	source->BindToTextureUnit(GL_TEXTURE0);
+	glUniform1i(shader->loc_textures[0], 0);
+	glBindImageTexture(0, target->GetTextureID(), 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+
+	glDispatchCompute((resolution.x + 15) / 16, (resolution.y + 15) / 16, 1);
+	glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+	return target;
+}
+
+void ComputeBlur::GetGaussianBoxes(int radius, int boxes[3])
+{
+	// The Gaussian ends at 3 sigma, each box of width w adds (w * w - 1) / 12 to the variance
+	float sigma = radius / 3.0f;
+	float idealWidth = std::sqrt(12.0f * sigma * sigma / 3.0f + 1.0f);
+
+	int lower = static_cast<int>(std::floor(idealWidth));
+	if (lower % 2 == 0)
+		lower--;
+	int upper = lower + 2;
+
+	// The first ones are narrower, the rest wider, to match the variance
+	float narrow = (12.0f * sigma * sigma - 3 * lower * lower - 12 * lower - 9) / (-4.0f * lower - 4.0f);
+	int narrowCount = static_cast<int>(std::round(narrow));
+
+	for (int i = 0; i < 3; i++)
+		boxes[i] = ((i < narrowCount ? lower : upper) - 1) / 2;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <include/glm.h>
+
+#include <Core/GPU/FrameBuffer.h>
+
+class Shader;
+class Texture2D;
+
+enum BlurKernel
+{
+	// One pass for each direction, Blur.CS.glsl
+	BLUR_KERNEL_BOX,
+	// Three box passes for each direction, close to a Gaussian of the same radius
+	BLUR_KERNEL_GAUSSIAN,
+	// Diagonal taps further apart with each pass, Kawase.CS.glsl
+	BLUR_KERNEL_KAWASE,
+	BLUR_KERNELS_COUNT
+};
+
+// Full resolution blur in compute shaders, ping-ponging between two half float targets.
+// The box passes cost the same for any radius up to MAX_RADIUS, the Kawase passes get one
+// more pass for each few texels of radius but only read 4 texels each.
+class ComputeBlur
+{
+public:
+	ComputeBlur();
+	~ComputeBlur();
+
+	void Generate(const glm::ivec2 &resolution);
+
+	// Blurs the source into one of the targets and returns it, the source must be of the same size
+	Texture2D* Apply(Texture2D *source, Shader *boxBlur, Shader *kawaseBlur, BlurKernel kernel, int radius);
+
+	static const char* GetKernelName(BlurKernel kernel);
+
+	// Apron of a tile in Blur.CS.glsl
+	static const int MAX_RADIUS = 128;
+	static const int TILE_SIZE = 256;
+
+private:
+	// Both write the next target and return it
+	Texture2D* BoxPass(Texture2D *source, Shader *shader, const glm::ivec2 &direction, int radius);
+	Texture2D* KawasePass(Texture2D *source, Shader *shader, int offset);
+
+	// Radii of 3 consecutive boxes with the variance of a Gaussian of the given radius
+	static void GetGaussianBoxes(int radius, int boxes[3]);
+
+private:
+	FrameBuffer targets;
+	glm::ivec2 resolution;
+	int next;
+};
@@ -0,0 +1,148 @@
+#include "GizmoBatch.h"
+
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+
+#include <include/utils.h>
+#include <Core/GPU/RenderState.h>
+
+GizmoBatch::GizmoBatch()
+{
+	uploadedCount = 0;
+	VAO = 0;
+	quadBuffer = 0;
+	instanceBuffer = 0;
+	instanceCapacity = 0;
+}
+
+GizmoBatch::~GizmoBatch()
+{
+	if (VAO)
+	{
+		RenderState::DeleteBuffers(1, &quadBuffer);
+		RenderState::DeleteBuffers(1, &instanceBuffer);
+		RenderState::DeleteVertexArrays(1, &VAO);
+	}
+}
+
+void GizmoBatch::Begin()
+{
+	instances.clear();
+}
+
+void GizmoBatch::Add(const glm::vec3 &position, float scale, bool selected)
+{
+	Instance instance;
+	instance.position = position;
+	instance.scale = scale;
+	instance.selected = selected ? 1.0f : 0.0f;
+	instances.push_back(instance);
+}
+
+void GizmoBatch::Upload()
+{
+	if (!VAO)
+		CreateBuffers();
+
+	uploadedCount = 0;
+	if (instances.empty())
+	{
+		uploaded.clear();
+		return;
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+
+	if (instances.size() > instanceCapacity)
+	{
+		instanceCapacity = std::max(instances.size(), 2 * instanceCapacity);
+		glBufferData(GL_ARRAY_BUFFER, instanceCapacity * sizeof(Instance), nullptr, GL_STREAM_DRAW);
+		uploaded.clear();
+	}
+
+	// Range of the instances that differ from the buffer, new ones included
+	size_t first = 0;
+	size_t common = std::min(instances.size(), uploaded.size());
+	while (first < common && memcmp(&instances[first], &uploaded[first], sizeof(Instance)) == 0)
+		first++;
+
+	size_t last = instances.size();
+	if (last == uploaded.size())
+	{
+		while (last > first && memcmp(&instances[last - 1], &uploaded[last - 1], sizeof(Instance)) == 0)
+			last--;
+	}
+
+	if (last > first)
+	{
+		glBufferSubData(GL_ARRAY_BUFFER, first * sizeof(Instance), (last - first) * sizeof(Instance), &instances[first]);
+		uploadedCount = static_cast<int>(last - first);
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	CheckOpenGLError();
+
+	uploaded.swap(instances);
+}
+
+void GizmoBatch::Draw() const
+{
+	if (!VAO || uploaded.empty())
+		return;
+
+	RenderState::BindVertexArray(VAO);
+	glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(uploaded.size()));
+}
+
+int GizmoBatch::GetCount() const
+{
+	return static_cast<int>(uploaded.size());
+}
+
+int GizmoBatch::GetUploadedCount() const
+{
+	return uploadedCount;
+}
+
+void GizmoBatch::CreateBuffers()
+{
+	// Unit quad as a triangle strip, position and texture coordinates
+	const GLfloat quad[] =
+	{
+		-0.5f, -0.5f, 0.0f,		0.0f, 0.0f,
+		 0.5f, -0.5f, 0.0f,		1.0f, 0.0f,
+		-0.5f,  0.5f, 0.0f,		0.0f, 1.0f,
+		 0.5f,  0.5f, 0.0f,		1.0f, 1.0f
+	};
+
+	glGenVertexArrays(1, &VAO);
+	glGenBuffers(1, &quadBuffer);
+	glGenBuffers(1, &instanceBuffer);
+
+	RenderState::BindVertexArray(VAO);
+
+	glBindBuffer(GL_ARRAY_BUFFER, quadBuffer);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+
+	// Same locations as VertexFormat
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(GLfloat), 0);
+
+	glEnableVertexAttribArray(2);
+	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(GLfloat), (void*)(3 * sizeof(GLfloat)));
+
+	// One of each for every instance
+	glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+
+	glEnableVertexAttribArray(3);
+	glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(Instance), 0);
+	glVertexAttribDivisor(3, 1);
+
+	glEnableVertexAttribArray(4);
+	glVertexAttribPointer(4, 1, GL_FLOAT, GL_FALSE, sizeof(Instance), (void*)(offsetof(Instance, selected)));
+	glVertexAttribDivisor(4, 1);
+
+	RenderState::BindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	CheckOpenGLError();
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vector>
+
+#include <include/gl.h>
+#include <include/glm.h>
+
+// Textured quads for the control points, drawn with a single instanced call.
+// The instances of a frame are collected between Begin() and Upload(), then compared with the
+// ones already on the GPU, so only the range that changed since the last frame is sent.
+// Gizmo.VS.glsl reads the position, the scale and the selection state of each instance.
+class GizmoBatch
+{
+public:
+	GizmoBatch();
+	~GizmoBatch();
+
+	void Begin();
+	void Add(const glm::vec3 &position, float scale, bool selected = false);
+
+	// Sends the instances that changed, the buffer is only reallocated when it grows
+	void Upload();
+
+	void Draw() const;
+
+	int GetCount() const;
+
+	// Instances sent by the last Upload()
+	int GetUploadedCount() const;
+
+private:
+	// Attributes 3 and 4 of Gizmo.VS.glsl
+	struct Instance
+	{
+		glm::vec3 position;
+		float scale;
+		float selected;
+	};
+
+	void CreateBuffers();
+
+private:
+	// Collected since Begin()
+	std::vector<Instance> instances;
+
+	// Copy of the instance buffer
+	std::vector<Instance> uploaded;
+	int uploadedCount;
+
+	GLuint VAO;
+	GLuint quadBuffer;
+	GLuint instanceBuffer;
+	size_t instanceCapacity;
+};
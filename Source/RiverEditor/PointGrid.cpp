@@ -0,0 +1,127 @@
+#include "PointGrid.h"
+
+#include <algorithm>
+
+PointGrid::PointGrid(float cellSize)
+{
+	this->cellSize = cellSize;
+}
+
+void PointGrid::SetCellSize(float cellSize)
+{
+	this->cellSize = cellSize;
+
+	// The cells depend on the size
+	std::vector<glm::vec3> copy = points;
+	Build(copy);
+}
+
+float PointGrid::GetCellSize() const
+{
+	return cellSize;
+}
+
+void PointGrid::Build(const std::vector<glm::vec3> &points)
+{
+	Clear();
+	this->points = points;
+	for (int i = 0; i < static_cast<int>(points.size()); i++)
+	{
+		Insert(i);
+	}
+}
+
+void PointGrid::Clear()
+{
+	points.clear();
+	cells.clear();
+}
+
+void PointGrid::Add(const glm::vec3 &point)
+{
+	points.push_back(point);
+	Insert(static_cast<int>(points.size()) - 1);
+}
+
+void PointGrid::Move(int index, const glm::vec3 &point)
+{
+	if (GetCell(point) == GetCell(points[index]))
+	{
+		points[index] = point;
+		return;
+	}
+
+	Remove(index);
+	points[index] = point;
+	Insert(index);
+}
+
+int PointGrid::FindNearest(const glm::vec3 &position, float radius) const
+{
+	glm::ivec2 minCell = GetCell(position - glm::vec3(radius));
+	glm::ivec2 maxCell = GetCell(position + glm::vec3(radius));
+
+	int nearest = -1;
+	float nearestDistance = radius * radius;
+	for (int x = minCell.x; x <= maxCell.x; x++)
+	{
+		for (int y = minCell.y; y <= maxCell.y; y++)
+		{
+			auto cell = cells.find(GetKey(glm::ivec2(x, y)));
+			if (cell == cells.end())
+				continue;
+
+			for (int index : cell->second)
+			{
+				glm::vec3 delta = points[index] - position;
+				float distance = glm::dot(delta, delta);
+				if (distance < nearestDistance)
+				{
+					nearestDistance = distance;
+					nearest = index;
+				}
+			}
+		}
+	}
+	return nearest;
+}
+
+int PointGrid::GetPointsCount() const
+{
+	return static_cast<int>(points.size());
+}
+
+glm::ivec2 PointGrid::GetCell(const glm::vec3 &point) const
+{
+	return glm::ivec2(glm::floor(glm::vec2(point) / cellSize));
+}
+
+PointGrid::CellKey PointGrid::GetKey(const glm::ivec2 &cell)
+{
+	// Shifted as unsigned, negative coordinates would make the shift undefined
+	return (static_cast<CellKey>(static_cast<unsigned int>(cell.x)) << 32) | static_cast<unsigned int>(cell.y);
+}
+
+void PointGrid::Insert(int index)
+{
+	cells[GetKey(GetCell(points[index]))].push_back(index);
+}
+
+void PointGrid::Remove(int index)
+{
+	auto cell = cells.find(GetKey(GetCell(points[index])));
+	if (cell == cells.end())
+		return;
+
+	// Order inside a cell doesn't matter
+	std::vector<int> &indices = cell->second;
+	auto it = std::find(indices.begin(), indices.end(), index);
+	if (it != indices.end())
+	{
+		*it = indices.back();
+		indices.pop_back();
+	}
+
+	if (indices.empty())
+		cells.erase(cell);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+
+#include <include/glm.h>
+
+// Uniform grid over the XoY plane, used to pick control points.
+// Only the occupied cells are stored, so the grid has no bounds.
+// A query within a radius only visits the cells that overlap it.
+class PointGrid
+{
+public:
+	PointGrid(float cellSize = 1.0f);
+
+	void SetCellSize(float cellSize);
+	float GetCellSize() const;
+
+	// Replaces every point, the index of a point is its position in the vector
+	void Build(const std::vector<glm::vec3> &points);
+	void Clear();
+
+	// Points are appended, so the index is always the current count
+	void Add(const glm::vec3 &point);
+
+	// Only touches the grid if the point changes its cell
+	void Move(int index, const glm::vec3 &point);
+
+	// Nearest point closer than radius, -1 if there is none
+	int FindNearest(const glm::vec3 &position, float radius) const;
+
+	int GetPointsCount() const;
+
+private:
+	typedef unsigned long long CellKey;
+
+	glm::ivec2 GetCell(const glm::vec3 &point) const;
+	static CellKey GetKey(const glm::ivec2 &cell);
+
+	void Insert(int index);
+	void Remove(int index);
+
+private:
+	float cellSize;
+	std::vector<glm::vec3> points;
+	std::unordered_map<CellKey, std::vector<int>> cells;
+};
@@ -0,0 +1,224 @@
+#include "PostProcessGraph.h"
+
+#include <cstdio>
+#include <algorithm>
+
+#include <include/utils.h>
+#include <Core/GPU/FrameBuffer.h>
+#include <Core/GPU/Mesh.h>
+#include <Core/GPU/Shader.h>
+#include <Core/GPU/Texture2D.h>
+#include <Core/GPU/RenderState.h>
+#include <Core/GPU/GPUProfiler.h>
+
+PostProcessGraph::PostProcessGraph()
+{
+	quad = nullptr;
+	shaders = {};
+	resolution = glm::ivec2(0);
+	settings = nullptr;
+	image = nullptr;
+	imageTarget = nullptr;
+	bloom = nullptr;
+	imageInBloomChain = false;
+	statistics = { 0, 0, 0 };
+}
+
+void PostProcessGraph::Init(Mesh *quad, const Shaders &shaders)
+{
+	this->quad = quad;
+	this->shaders = shaders;
+}
+
+void PostProcessGraph::Generate(const glm::ivec2 &resolution, int bloomLevels)
+{
+	this->resolution = resolution;
+
+	bloomChain.Generate(resolution, bloomLevels);
+	computeBlur.Generate(resolution);
+	pool.Trim();
+}
+
+void PostProcessGraph::SetEffects(const std::vector<PostEffect> &effects)
+{
+	this->effects = effects;
+}
+
+const std::vector<PostEffect>& PostProcessGraph::GetEffects() const
+{
+	return effects;
+}
+
+void PostProcessGraph::Render(Texture2D *frame, const Settings &settings, const glm::ivec2 &viewport)
+{
+	statistics = { 0, 0, 0 };
+	if (!frame || !quad || !shaders.composite || !shaders.composite->program)
+		return;
+
+	this->settings = &settings;
+	stages.clear();
+	image = frame;
+	imageTarget = nullptr;
+	bloom = nullptr;
+	imageInBloomChain = false;
+
+	for (PostEffect effect : effects)
+	{
+		switch (effect)
+		{
+		case POST_EFFECT_BLOOM:
+		{
+			// The chain can't read its own levels while writing them
+			Flush(imageInBloomChain);
+
+			{
+				GPUProfiler::Scope scope("Bloom chain");
+				bloom = bloomChain.Apply(image, quad, shaders.bloomDown, shaders.bloomUp,
+										 settings.bloomThreshold, settings.bloomLevels, true);
+			}
+
+			if (bloom)
+				AddStage(STAGE_BLOOM);
+			break;
+		}
+
+		case POST_EFFECT_BLUR:
+		{
+			Flush(imageInBloomChain && !settings.computeBlur);
+
+			GPUProfiler::Scope scope("Blur");
+			if (settings.computeBlur)
+			{
+				SetImage(computeBlur.Apply(image, shaders.boxBlur, shaders.kawaseBlur, settings.blurKernel, settings.blurRadius), nullptr);
+			}
+			else
+			{
+				Texture2D *blurred = bloomChain.Apply(image, quad, shaders.bloomDown, shaders.bloomUp, 0.0f, settings.blurLevels, false);
+				if (blurred)
+				{
+					SetImage(blurred, nullptr);
+					imageInBloomChain = true;
+				}
+			}
+			break;
+		}
+
+		case POST_EFFECT_WAVE:
+			AddStage(STAGE_WAVE);
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	// Whatever is left is drawn on the screen
+	DrawStages(nullptr, viewport);
+	SetImage(nullptr, nullptr);
+
+	// The next frame is drawn into these textures, they can't stay bound
+	RenderState::BindTextureUnit(0, GL_TEXTURE_2D, 0);
+	RenderState::BindTextureUnit(1, GL_TEXTURE_2D, 0);
+	CheckOpenGLError();
+
+	statistics.pooledTargets = pool.GetTargetsCount();
+	this->settings = nullptr;
+}
+
+const PostProcessGraph::Statistics& PostProcessGraph::GetStatistics() const
+{
+	return statistics;
+}
+
+const char* PostProcessGraph::GetEffectName(PostEffect effect)
+{
+	switch (effect)
+	{
+	case POST_EFFECT_BLOOM:
+		return "bloom";
+	case POST_EFFECT_BLUR:
+		return "blur";
+	case POST_EFFECT_WAVE:
+		return "wave";
+	default:
+		return "unknown";
+	}
+}
+
+void PostProcessGraph::AddStage(Stage stage)
+{
+	if (stages.size() == MAX_STAGES)
+		Flush();
+
+	stages.push_back(stage);
+}
+
+void PostProcessGraph::Flush(bool force)
+{
+	if (stages.empty() && !force)
+		return;
+
+	FrameBuffer *target = pool.Acquire(resolution);
+	DrawStages(target, resolution);
+	SetImage(target->GetTexture(0), target);
+}
+
+void PostProcessGraph::DrawStages(FrameBuffer *target, const glm::ivec2 &viewport)
+{
+	GPUProfiler::Scope scope("Composite");
+
+	if (target)
+		target->Bind(false);
+	else
+		FrameBuffer::BindDefault(viewport);
+
+	RenderState::SetBlend(false);
+	RenderState::SetDepthTest(false);
+
+	Shader *shader = shaders.composite;
+	shader->Use();
+	shader->SetUniform("stages_count", static_cast<int>(stages.size()));
+	for (size_t i = 0; i < stages.size(); i++)
+	{
+		char name[32];
+		sprintf(name, "stages[%d]", static_cast<int>(i));
+		shader->SetUniform(name, static_cast<int>(stages[i]));
+	}
+
+	// Only the last pass can be larger than the internal resolution
+	shader->SetUniform("upscale", (!target && viewport != resolution) ? 1 : 0);
+
+	shader->SetUniform("time", settings->time);
+	shader->SetUniform("frequency", settings->waveFrequency);
+
+	// Every level of the chain adds its own copy of the bright spots
+	shader->SetUniform("bloom_intensity", settings->bloomIntensity / std::max(settings->bloomLevels, 1));
+
+	quad->UseMaterials(false);
+	image->BindToTextureUnit(GL_TEXTURE0);
+	glUniform1i(shader->loc_textures[0], 0);
+	if (bloom)
+	{
+		bloom->BindToTextureUnit(GL_TEXTURE1);
+		glUniform1i(shader->loc_textures[1], 1);
+	}
+
+	quad->Render();
+	RenderState::SetDepthTest(true);
+
+	statistics.passes++;
+	statistics.stages += static_cast<unsigned int>(stages.size());
+
+	stages.clear();
+	bloom = nullptr;
+}
+
+void PostProcessGraph::SetImage(Texture2D *texture, FrameBuffer *pooledTarget)
+{
+	if (imageTarget)
+		pool.Release(imageTarget);
+
+	image = texture;
+	imageTarget = pooledTarget;
+	imageInBloomChain = false;
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <vector>
+
+#include "BloomChain.h"
+#include "ComputeBlur.h"
+
+#include <include/glm.h>
+#include <Core/GPU/RenderTargetPool.h>
+
+class FrameBuffer;
+class Mesh;
+class Shader;
+class Texture2D;
+
+enum PostEffect
+{
+	POST_EFFECT_BLOOM,
+	POST_EFFECT_BLUR,
+	POST_EFFECT_WAVE,
+	POST_EFFECTS_COUNT
+};
+
+// Post processing effects applied to the frame one after the other, in any order.
+// Effects that only change the pixel they write, or where it is read from, are stages of
+// PostProcess.FS.glsl and consecutive stages are drawn together in one full screen pass.
+// Effects that read whole neighbourhoods need the image so far in a texture, so the pending stages
+// are drawn into a target of the pool before them, released once the next image replaces it.
+// The bloom is both: its chain reads the image, adding it back is a stage, so bloom then wave
+// costs a single full screen pass after the chain.
+class PostProcessGraph
+{
+public:
+	struct Shaders
+	{
+		// PostProcess.FS.glsl
+		Shader *composite;
+		Shader *bloomDown;
+		Shader *bloomUp;
+		Shader *boxBlur;
+		Shader *kawaseBlur;
+	};
+
+	struct Settings
+	{
+		float bloomThreshold;
+		float bloomIntensity;
+		int bloomLevels;
+
+		// Without compute shaders the blur goes down the bloom chain instead
+		bool computeBlur;
+		BlurKernel blurKernel;
+		int blurRadius;
+		int blurLevels;
+
+		float waveFrequency;
+		float time;
+	};
+
+	// Of the last Render()
+	struct Statistics
+	{
+		unsigned int passes;
+		unsigned int stages;
+		int pooledTargets;
+	};
+
+public:
+	PostProcessGraph();
+
+	void Init(Mesh *quad, const Shaders &shaders);
+
+	// Targets for frames of this resolution, the bloom chain can't go deeper than its levels
+	void Generate(const glm::ivec2 &resolution, int bloomLevels);
+
+	void SetEffects(const std::vector<PostEffect> &effects);
+	const std::vector<PostEffect>& GetEffects() const;
+
+	// Applies the effects to the frame, the last pass draws in the default frame buffer.
+	// A frame smaller than the viewport is upscaled by that pass.
+	void Render(Texture2D *frame, const Settings &settings, const glm::ivec2 &viewport);
+
+	const Statistics& GetStatistics() const;
+
+	static const char* GetEffectName(PostEffect effect);
+
+private:
+	// Same values in PostProcess.FS.glsl
+	enum Stage
+	{
+		STAGE_WAVE,
+		STAGE_BLOOM
+	};
+	static const int MAX_STAGES = 8;
+
+	void AddStage(Stage stage);
+
+	// Draws the pending stages into a pooled target, which becomes the image.
+	// The image is copied even without stages if forced.
+	void Flush(bool force = false);
+
+	// In the default frame buffer if there's no target
+	void DrawStages(FrameBuffer *target, const glm::ivec2 &viewport);
+
+	// The pooled target of the previous image goes back to the pool
+	void SetImage(Texture2D *texture, FrameBuffer *pooledTarget);
+
+private:
+	std::vector<PostEffect> effects;
+
+	Mesh *quad;
+	Shaders shaders;
+	glm::ivec2 resolution;
+
+	BloomChain bloomChain;
+	ComputeBlur computeBlur;
+	RenderTargetPool pool;
+
+	// State of the current Render()
+	const Settings *settings;
+	std::vector<Stage> stages;
+	Texture2D *image;
+	FrameBuffer *imageTarget;
+	Texture2D *bloom;
+	bool imageInBloomChain;
+
+	Statistics statistics;
+};
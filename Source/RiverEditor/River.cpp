@@ -0,0 +1,357 @@
+#include "River.h"
+
+#include <algorithm>
+
+#include <include/utils.h>
+#include <Core/GPU/Shader.h>
+#include <Core/GPU/RenderState.h>
+
+River::River()
+{
+	VAO = 0;
+	segmentBuffer = 0;
+	arcLengthBuffer = 0;
+	capacity = 0;
+
+	meshVAO = 0;
+	meshBuffer = 0;
+	meshIndexBuffer = 0;
+	meshCapacity = 0;
+	meshValid = false;
+
+	computeVAO = 0;
+	computeCommandBuffer = 0;
+	computeCapacity = 0;
+	computePointsPerSegment = 0;
+	computeValid = false;
+}
+
+River::~River()
+{
+	if (segmentBuffer)
+	{
+		RenderState::DeleteBuffers(1, &segmentBuffer);
+		RenderState::DeleteBuffers(1, &arcLengthBuffer);
+		RenderState::DeleteVertexArrays(1, &VAO);
+	}
+
+	if (meshBuffer)
+	{
+		RenderState::DeleteBuffers(1, &meshBuffer);
+		RenderState::DeleteBuffers(1, &meshIndexBuffer);
+		RenderState::DeleteVertexArrays(1, &meshVAO);
+	}
+
+	if (computeVAO)
+	{
+		RenderState::DeleteBuffers(1, &computeCommandBuffer);
+		RenderState::DeleteVertexArrays(1, &computeVAO);
+	}
+}
+
+Spline& River::GetSpline()
+{
+	return spline;
+}
+
+const Spline& River::GetSpline() const
+{
+	return spline;
+}
+
+void River::UploadSegments()
+{
+	if (!spline.IsDirty())
+		return;
+
+	int segmentCount = spline.GetSegmentCount();
+	const std::vector<glm::vec4> &points = spline.GetSegmentPoints();
+	const std::vector<glm::vec4> &arcLengths = spline.GetArcLengthTable();
+
+	// The cached surface of the same segments is now stale
+	int first = spline.GetFirstDirtySegment();
+	meshDirtySegments.Add(first, first + spline.GetDirtySegmentsCount());
+	computeDirtySegments.Add(first, first + spline.GetDirtySegmentsCount());
+
+	if (segmentCount > capacity)
+	{
+		// Grow geometrically so appending points doesn't reallocate every time
+		CreateBuffers(std::max(segmentCount, 2 * capacity));
+
+		glBindBuffer(GL_ARRAY_BUFFER, segmentBuffer);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, points.size() * sizeof(glm::vec4), points.data());
+		glBindBuffer(GL_ARRAY_BUFFER, arcLengthBuffer);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, arcLengths.size() * sizeof(glm::vec4), arcLengths.data());
+	}
+	else
+	{
+		// Only the segments that use the edited points
+		int count = std::min(spline.GetDirtySegmentsCount(), segmentCount - first);
+		if (count > 0)
+		{
+			glBindBuffer(GL_ARRAY_BUFFER, segmentBuffer);
+			glBufferSubData(GL_ARRAY_BUFFER, 4 * first * sizeof(glm::vec4), 4 * count * sizeof(glm::vec4), &points[4 * first]);
+			glBindBuffer(GL_ARRAY_BUFFER, arcLengthBuffer);
+			glBufferSubData(GL_ARRAY_BUFFER, 4 * first * sizeof(glm::vec4), 4 * count * sizeof(glm::vec4), &arcLengths[4 * first]);
+		}
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	CheckOpenGLError();
+
+	spline.ClearDirty();
+}
+
+void River::Draw(int instanceCount) const
+{
+	int segmentCount = spline.GetSegmentCount();
+	if (!VAO || segmentCount == 0)
+		return;
+
+	RenderState::BindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, arcLengthBuffer);
+
+	RenderState::BindVertexArray(VAO);
+	glDrawArraysInstanced(GL_LINES_ADJACENCY, 0, 4 * segmentCount, instanceCount);
+}
+
+void River::DrawPatches(int instanceCount) const
+{
+	int segmentCount = spline.GetSegmentCount();
+	if (!VAO || segmentCount == 0)
+		return;
+
+	RenderState::BindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, arcLengthBuffer);
+
+	RenderState::BindVertexArray(VAO);
+	glDrawArraysInstanced(GL_PATCHES, 0, 4 * segmentCount, instanceCount);
+}
+
+void River::UpdateMesh(const RiverMeshSettings &settings)
+{
+	int segmentCount = spline.GetSegmentCount();
+
+	// Every segment depends on the settings
+	if (!meshValid || settings != meshSettings)
+	{
+		meshSettings = settings;
+		meshDirtySegments.Add(0, segmentCount);
+		meshValid = true;
+	}
+
+	if (segmentCount > meshCapacity)
+	{
+		CreateMeshBuffers(std::max(segmentCount, 2 * meshCapacity));
+		meshDirtySegments.Add(0, segmentCount);
+	}
+
+	meshOffsets.resize(segmentCount);
+	meshCounts.resize(segmentCount);
+
+	int first = meshDirtySegments.begin;
+	int last = std::min(meshDirtySegments.end, segmentCount);
+	if (last <= first)
+		return;
+
+	for (int i = first; i < last; i++)
+	{
+		TessellateSegment(i);
+	}
+
+	// A single upload for the whole range of slots
+	const int slotSize = 2 * MAX_POINTS_PER_SEGMENT;
+	glBindBuffer(GL_ARRAY_BUFFER, meshBuffer);
+	glBufferSubData(GL_ARRAY_BUFFER, first * slotSize * sizeof(RiverVertex), (last - first) * slotSize * sizeof(RiverVertex),
+					&meshVertices[first * slotSize]);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	// The index buffer is reached through its vertex array
+	RenderState::BindVertexArray(meshVAO);
+	glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, first * slotSize * sizeof(GLuint), (last - first) * slotSize * sizeof(GLuint),
+					&meshIndices[first * slotSize]);
+	RenderState::BindVertexArray(0);
+	CheckOpenGLError();
+
+	meshDirtySegments.Clear();
+}
+
+void River::DrawMesh() const
+{
+	int segmentCount = spline.GetSegmentCount();
+	if (!meshVAO || segmentCount == 0)
+		return;
+
+	RenderState::BindVertexArray(meshVAO);
+	glMultiDrawElements(GL_TRIANGLE_STRIP, meshCounts.data(), GL_UNSIGNED_INT, meshOffsets.data(), segmentCount);
+}
+
+void River::UpdateComputeMesh(Shader *shader, const RiverMeshSettings &settings)
+{
+	int segmentCount = spline.GetSegmentCount();
+	if (!shader || segmentCount == 0)
+		return;
+
+	if (!computeValid || settings != computeSettings)
+	{
+		computeSettings = settings;
+		computeDirtySegments.Add(0, segmentCount);
+		computeValid = true;
+	}
+
+	int capacity = computeCapacity;
+	if (segmentCount > capacity)
+		capacity = std::max(segmentCount, 2 * capacity);
+
+	// The slots are sized from the requested points count, any change reallocates them
+	// Adaptive mode gets at least the same room as the geometry shader
+	// Long rivers get smaller slots, so the buffer doesn't grow with the points count
+	int pointsPerSegment = std::max(settings.pointsCount, 2);
+	if (settings.mode == TESSELLATION_ADAPTIVE)
+		pointsPerSegment = std::max(pointsPerSegment, static_cast<int>(MAX_POINTS_PER_SEGMENT));
+	pointsPerSegment = std::min(pointsPerSegment, std::max(MAX_COMPUTE_VERTICES / (2 * capacity), 2));
+
+	if (capacity != computeCapacity || pointsPerSegment != computePointsPerSegment)
+	{
+		CreateComputeBuffers(capacity, pointsPerSegment);
+		computeDirtySegments.Add(0, segmentCount);
+	}
+
+	int first = computeDirtySegments.begin;
+	int last = std::min(computeDirtySegments.end, segmentCount);
+	if (last <= first)
+		return;
+
+	shader->Use();
+
+	shader->SetUniform("first_segment", first);
+	shader->SetUniform("segments_count", last - first);
+	shader->SetUniform("points_per_segment", computePointsPerSegment);
+	shader->SetUniform("surface_width", settings.width);
+	shader->SetUniform("tilingFactor", settings.tilingFactor);
+	shader->SetUniform("tessellation_mode", static_cast<int>(settings.mode));
+	shader->SetUniform("flatness_tolerance", settings.flatnessTolerance);
+	shader->SetUniform("world_to_screen", settings.worldToScreen);
+
+	// The segment points are read straight from the vertex buffer
+	RenderState::BindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, segmentBuffer);
+	RenderState::BindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, arcLengthBuffer);
+	RenderState::BindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, computeCommandBuffer);
+	computeBuffer->BindBuffer(2);
+
+	// One invocation for each point of the dirty segments
+	GLuint invocations = (last - first) * computePointsPerSegment;
+	glDispatchCompute((invocations + 63) / 64, 1, 1);
+
+	// The vertex shader reads the vertices and the draw reads the commands
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+	CheckOpenGLError();
+
+	computeDirtySegments.Clear();
+}
+
+void River::DrawComputeMesh(Shader *shader) const
+{
+	int segmentCount = spline.GetSegmentCount();
+	if (!shader || !computeVAO || segmentCount == 0)
+		return;
+
+	computeBuffer->BindBuffer(2);
+
+	// No vertex attributes, every command draws the triangle strip of a segment
+	RenderState::BindVertexArray(computeVAO);
+	RenderState::BindBuffer(GL_DRAW_INDIRECT_BUFFER, computeCommandBuffer);
+	glMultiDrawArraysIndirect(GL_TRIANGLE_STRIP, 0, segmentCount, 0);
+}
+
+GLuint River::GetSegmentBuffer() const
+{
+	return segmentBuffer;
+}
+
+void River::CreateBuffers(int capacity)
+{
+	this->capacity = capacity;
+
+	if (!VAO)
+	{
+		glGenVertexArrays(1, &VAO);
+		glGenBuffers(1, &segmentBuffer);
+		glGenBuffers(1, &arcLengthBuffer);
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, arcLengthBuffer);
+	glBufferData(GL_ARRAY_BUFFER, 4 * capacity * sizeof(glm::vec4), nullptr, GL_DYNAMIC_DRAW);
+
+	RenderState::BindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, segmentBuffer);
+	glBufferData(GL_ARRAY_BUFFER, 4 * capacity * sizeof(glm::vec4), nullptr, GL_DYNAMIC_DRAW);
+
+	// The position and, in w, the width profile of the segment
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), 0);
+
+	RenderState::BindVertexArray(0);
+	CheckOpenGLError();
+}
+
+void River::CreateMeshBuffers(int capacity)
+{
+	meshCapacity = capacity;
+	meshVertices.resize(capacity * 2 * MAX_POINTS_PER_SEGMENT);
+	meshIndices.resize(meshVertices.size());
+
+	if (!meshVAO)
+	{
+		glGenVertexArrays(1, &meshVAO);
+		glGenBuffers(1, &meshBuffer);
+		glGenBuffers(1, &meshIndexBuffer);
+	}
+
+	RenderState::BindVertexArray(meshVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, meshBuffer);
+	glBufferData(GL_ARRAY_BUFFER, meshVertices.size() * sizeof(RiverVertex), nullptr, GL_DYNAMIC_DRAW);
+
+	// The index buffer binding is part of the vertex array
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, meshIndexBuffer);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, meshIndices.size() * sizeof(GLuint), nullptr, GL_DYNAMIC_DRAW);
+
+	// Same locations as VertexFormat
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(RiverVertex), 0);
+
+	glEnableVertexAttribArray(2);
+	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(RiverVertex), (void*)(sizeof(glm::vec3)));
+
+	RenderState::BindVertexArray(0);
+	CheckOpenGLError();
+}
+
+void River::CreateComputeBuffers(int capacity, int pointsPerSegment)
+{
+	computeCapacity = capacity;
+	computePointsPerSegment = pointsPerSegment;
+	computeBuffer = std::unique_ptr< SSBO<RiverComputeVertex> >(
+						new SSBO<RiverComputeVertex>(capacity * 2 * pointsPerSegment));
+
+	// Core profile needs a vertex array bound even if it has no attributes
+	if (!computeVAO)
+	{
+		glGenVertexArrays(1, &computeVAO);
+		glGenBuffers(1, &computeCommandBuffer);
+	}
+
+	RenderState::BindBuffer(GL_DRAW_INDIRECT_BUFFER, computeCommandBuffer);
+	glBufferData(GL_DRAW_INDIRECT_BUFFER, capacity * sizeof(RiverDrawCommand), nullptr, GL_DYNAMIC_DRAW);
+	CheckOpenGLError();
+}
+
+void River::TessellateSegment(int segment)
+{
+	// Same number of points the geometry shader would generate
+	int pointsCount = SegmentTessellator::GetPointsCount(spline.GetSegment(segment), meshSettings);
+
+	int first = segment * 2 * MAX_POINTS_PER_SEGMENT;
+	tessellator.Tessellate(spline, segment, meshSettings, pointsCount, &meshVertices[first], &meshIndices[first], first);
+
+	meshOffsets[segment] = reinterpret_cast<const void*>(first * sizeof(GLuint));
+	meshCounts[segment] = 2 * pointsCount;
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+
+#include <include/gl.h>
+#include <include/utils.h>
+#include <Core/GPU/SSBO.h>
+
+#include "Spline.h"
+#include "SegmentTessellator.h"
+
+class Shader;
+
+// Vertex written by RiverTessellation.CS.glsl, std430 layout
+struct RiverComputeVertex
+{
+	glm::vec4 position;
+	glm::vec4 texCoord;
+};
+
+// glDrawArraysIndirect command written by RiverTessellation.CS.glsl for each segment
+struct RiverDrawCommand
+{
+	GLuint count;
+	GLuint instanceCount;
+	GLuint first;
+	GLuint baseInstance;
+};
+
+// River curve together with its GPU copies.
+// The Bezier points of each segment are stored in a vertex buffer and drawn as
+// GL_LINES_ADJACENCY primitives or patches, so the geometry or tessellation shaders
+// process one segment at a time.
+// The river surface can also be tessellated on the CPU and cached in a vertex buffer,
+// with a fixed slot for each segment so edits only rebuild the segments they touch.
+// Its banks are offset curves with the loops of tight bends trimmed, drawn as indexed strips.
+// The compute path uses the same slots in a storage buffer, filled on the GPU and
+// read back by the vertex shader, so the points count isn't bounded by the geometry shader.
+// The compute shader also writes the draw command of each segment, so only the points
+// it generated are drawn.
+class River
+{
+public:
+	River();
+	~River();
+
+	Spline& GetSpline();
+	const Spline& GetSpline() const;
+
+	// Sends the modified segments to the GPU and marks them for re-tessellation
+	void UploadSegments();
+
+	// Draws the segments, the tessellation is done by the bound shader
+	void Draw(int instanceCount) const;
+
+	// Draws every segment as a patch of 4 points, for the tessellation shaders
+	void DrawPatches(int instanceCount) const;
+
+	// Re-tessellates the segments that changed, everything if the settings changed
+	void UpdateMesh(const RiverMeshSettings &settings);
+
+	// Draws the cached surface, one indexed triangle strip for each segment
+	void DrawMesh() const;
+
+	// Same as UpdateMesh, but the dirty segments are tessellated by the compute shader
+	// In adaptive mode settings.pointsCount raises the upper bound of each segment
+	// The slots are shrunk so the storage buffer stays under MAX_COMPUTE_VERTICES
+	void UpdateComputeMesh(Shader *shader, const RiverMeshSettings &settings);
+
+	// Draws the compute surface, the bound shader reads the vertices from the storage buffer
+	void DrawComputeMesh(Shader *shader) const;
+
+	GLuint GetSegmentBuffer() const;
+
+	// Upper bound of points per segment, same as the geometry shader
+	static const int MAX_POINTS_PER_SEGMENT = SegmentTessellator::MAX_POINTS;
+
+	// Upper bound of the compute surface, 64 MB of vertices
+	static const int MAX_COMPUTE_VERTICES = 1 << 21;
+
+private:
+	void CreateBuffers(int capacity);
+	void CreateMeshBuffers(int capacity);
+	void CreateComputeBuffers(int capacity, int pointsPerSegment);
+	void TessellateSegment(int segment);
+
+private:
+	Spline spline;
+
+	GLuint VAO;
+	GLuint segmentBuffer;
+
+	// Arc length table of the segments, read by the shaders from binding 3
+	GLuint arcLengthBuffer;
+
+	// Number of segments that fit in the current GPU buffer
+	int capacity;
+
+	// Cached surface
+	GLuint meshVAO;
+	GLuint meshBuffer;
+	GLuint meshIndexBuffer;
+	int meshCapacity;
+	bool meshValid;
+	RiverMeshSettings meshSettings;
+	std::vector<RiverVertex> meshVertices;
+	std::vector<GLuint> meshIndices;
+	std::vector<const void*> meshOffsets;
+	std::vector<GLsizei> meshCounts;
+
+	SegmentRange meshDirtySegments;
+
+	// Surface tessellated by the compute shader
+	GLuint computeVAO;
+	std::unique_ptr< SSBO<RiverComputeVertex> > computeBuffer;
+	GLuint computeCommandBuffer;
+	int computeCapacity;
+	int computePointsPerSegment;
+	bool computeValid;
+	RiverMeshSettings computeSettings;
+	SegmentRange computeDirtySegments;
+
+	SegmentTessellator tessellator;
+};
@@ -0,0 +1,112 @@
+#include "RiverBanks.h"
+
+#include <algorithm>
+
+namespace
+{
+	float Cross(const glm::vec2 &a, const glm::vec2 &b)
+	{
+		return a.x * b.y - a.y * b.x;
+	}
+}
+
+void RiverBanks::Build(const glm::vec3 *points, const glm::vec3 *normals, int count, float distance, const float *scales)
+{
+	positions.resize(count);
+	mergedInto.resize(count);
+	for (int i = 0; i < count; i++)
+	{
+		positions[i] = points[i] + (scales ? distance * scales[i] : distance) * normals[i];
+		mergedInto[i] = i;
+	}
+
+	// A run of edges that go against the centerline is the inside of a loop
+	int i = 0;
+	while (i < count - 1)
+	{
+		glm::vec3 bankEdge = positions[i + 1] - positions[i];
+		glm::vec3 centerEdge = points[i + 1] - points[i];
+		if (glm::dot(bankEdge, centerEdge) >= 0.0f)
+		{
+			i++;
+			continue;
+		}
+
+		int last = i;
+		while (last + 1 < count - 1 &&
+				glm::dot(positions[last + 2] - positions[last + 1], points[last + 2] - points[last + 1]) < 0.0f)
+		{
+			last++;
+		}
+
+		// Continue after the samples that were merged
+		i = TrimLoop(i, last) + 1;
+	}
+}
+
+const std::vector<glm::vec3>& RiverBanks::GetPositions() const
+{
+	return positions;
+}
+
+const std::vector<int>& RiverBanks::GetMergedInto() const
+{
+	return mergedInto;
+}
+
+int RiverBanks::TrimLoop(int first, int last)
+{
+	int count = static_cast<int>(positions.size());
+
+	// The edges that cross are around the backwards run, a loop is about as wide as the run
+	int window = 2 * (last - first + 1) + 2;
+	for (int a = first - 1; a >= std::max(first - window, 0); a--)
+	{
+		for (int b = last + 1; b <= std::min(last + window, count - 2); b++)
+		{
+			glm::vec3 crossing;
+			if (Intersect(a, b, crossing))
+			{
+				Collapse(a + 1, b, crossing);
+				return b;
+			}
+		}
+	}
+
+	// No crossing inside the curve, the loop goes past one of its ends, so drop the backwards run
+	int end = last + 1;
+	if (first == 0)
+		Collapse(first, end, positions[end]);
+	else
+		Collapse(first, end, positions[first]);
+	return end;
+}
+
+bool RiverBanks::Intersect(int a, int b, glm::vec3 &crossing) const
+{
+	glm::vec2 p = glm::vec2(positions[a]);
+	glm::vec2 r = glm::vec2(positions[a + 1]) - p;
+	glm::vec2 q = glm::vec2(positions[b]);
+	glm::vec2 s = glm::vec2(positions[b + 1]) - q;
+
+	float denominator = Cross(r, s);
+	if (glm::abs(denominator) < 1e-12f)
+		return false;
+
+	float t = Cross(q - p, s) / denominator;
+	float u = Cross(q - p, r) / denominator;
+	if (t < 0.0f || t > 1.0f || u < 0.0f || u > 1.0f)
+		return false;
+
+	crossing = positions[a] + t * (positions[a + 1] - positions[a]);
+	return true;
+}
+
+void RiverBanks::Collapse(int first, int last, glm::vec3 position)
+{
+	for (int i = first; i <= last; i++)
+	{
+		positions[i] = position;
+		mergedInto[i] = first;
+	}
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <vector>
+
+#include <include/glm.h>
+
+// Offset curves of a sampled centerline, the two banks of the river.
+// Pushing every sample along the normal folds the bank over itself where the bend is
+// tighter than the offset. The loops are found where the bank runs backwards and are
+// cut at the point where the bank crosses itself.
+class RiverBanks
+{
+public:
+	// Offsets the centerline by distance along the normals, negative distances go to the other side
+	// Optional scales vary the distance for each sample, for rivers with a width profile
+	// Samples inside a loop are moved to the crossing and point to the sample they were merged into
+	void Build(const glm::vec3 *points, const glm::vec3 *normals, int count, float distance, const float *scales = nullptr);
+
+	const std::vector<glm::vec3>& GetPositions() const;
+
+	// Index of the sample each sample was merged into, itself if it wasn't trimmed
+	const std::vector<int>& GetMergedInto() const;
+
+private:
+	// Trims the loop around the backwards edges [first, last], returns the last merged sample
+	int TrimLoop(int first, int last);
+
+	// Crossing of the edges [a, a + 1] and [b, b + 1] in the XoY plane
+	bool Intersect(int a, int b, glm::vec3 &crossing) const;
+
+	// The position is copied, it may be one of the collapsed samples
+	void Collapse(int first, int last, glm::vec3 position);
+
+private:
+	std::vector<glm::vec3> positions;
+	std::vector<int> mergedInto;
+};
@@ -0,0 +1,197 @@
+#include "RiverBatch.h"
+#include "WorkStealingPool.h"
+
+#include <algorithm>
+
+#include <include/utils.h>
+#include <Core/GPU/RenderState.h>
+
+RiverBatch::RiverBatch()
+{
+	VAO = 0;
+	buffer = 0;
+	bufferCapacity = 0;
+}
+
+RiverBatch::~RiverBatch()
+{
+	if (buffer)
+	{
+		RenderState::DeleteBuffers(1, &buffer);
+		RenderState::DeleteVertexArrays(1, &VAO);
+	}
+}
+
+void RiverBatch::SetRivers(const std::vector<const Spline*> &rivers)
+{
+	this->rivers = rivers;
+
+	firstSegments.resize(rivers.size() + 1);
+	firstSegments[0] = 0;
+	for (size_t i = 0; i < rivers.size(); i++)
+		firstSegments[i + 1] = firstSegments[i] + rivers[i]->GetSegmentCount();
+
+	firsts.assign(firstSegments.back(), 0);
+	counts.assign(firstSegments.back(), 0);
+}
+
+int RiverBatch::GetRiversCount() const
+{
+	return static_cast<int>(rivers.size());
+}
+
+void RiverBatch::Tessellate(WorkStealingPool &pool, const RiverMeshSettings &settings)
+{
+	int riversCount = GetRiversCount();
+	if (riversCount == 0)
+		return;
+
+	// Points of every segment, the adaptive mode depends on the curve
+	pool.ParallelFor(riversCount, [&](int river, int worker)
+	{
+		const Spline &spline = *rivers[river];
+		for (int i = 0; i < spline.GetSegmentCount(); i++)
+		{
+			counts[firstSegments[river] + i] = 2 * SegmentTessellator::GetPointsCount(spline.GetSegment(i), settings);
+		}
+	});
+
+	// Place the strips one after the other in the arena
+	GLint vertexCount = 0;
+	for (size_t i = 0; i < counts.size(); i++)
+	{
+		firsts[i] = vertexCount;
+		vertexCount += counts[i];
+	}
+	arena.resize(vertexCount);
+
+	tessellators.resize(pool.GetWorkersCount());
+	pool.ParallelFor(riversCount, [&](int river, int worker)
+	{
+		const Spline &spline = *rivers[river];
+		for (int i = 0; i < spline.GetSegmentCount(); i++)
+		{
+			int strip = firstSegments[river] + i;
+			tessellators[worker].Tessellate(spline, i, settings, counts[strip] / 2, &arena[firsts[strip]]);
+		}
+	});
+
+	drawFirsts = firsts;
+	drawCounts = counts;
+}
+
+void RiverBatch::BuildLevels(WorkStealingPool &pool, const RiverMeshSettings &settings, int levelsCount, float baseTolerance)
+{
+	int riversCount = GetRiversCount();
+
+	lods.resize(riversCount);
+	pool.ParallelFor(riversCount, [&](int river, int worker)
+	{
+		lods[river].Build(*rivers[river], settings, levelsCount, baseTolerance);
+	});
+
+	// Every level of every river, one after the other
+	firstLevels.resize(riversCount + 1);
+	firstLevels[0] = 0;
+	for (int river = 0; river < riversCount; river++)
+		firstLevels[river + 1] = firstLevels[river] + lods[river].GetLevelsCount();
+
+	levelFirsts.resize(firstLevels[riversCount]);
+	levelCounts.resize(firstLevels[riversCount]);
+	GLint vertexCount = 0;
+	for (int river = 0; river < riversCount; river++)
+	{
+		for (int level = 0; level < lods[river].GetLevelsCount(); level++)
+		{
+			int strip = firstLevels[river] + level;
+			levelFirsts[strip] = vertexCount;
+			levelCounts[strip] = static_cast<GLsizei>(lods[river].GetVertices(level).size());
+			vertexCount += levelCounts[strip];
+		}
+	}
+	arena.resize(vertexCount);
+
+	pool.ParallelFor(riversCount, [&](int river, int worker)
+	{
+		for (int level = 0; level < lods[river].GetLevelsCount(); level++)
+		{
+			const std::vector<RiverVertex> &vertices = lods[river].GetVertices(level);
+			std::copy(vertices.begin(), vertices.end(), arena.begin() + levelFirsts[firstLevels[river] + level]);
+		}
+	});
+
+	drawFirsts.clear();
+	drawCounts.clear();
+}
+
+void RiverBatch::SelectLevels(const glm::mat4 &worldToScreen, const glm::vec2 &screenSize, float tolerancePixels)
+{
+	drawFirsts.clear();
+	drawCounts.clear();
+	for (int river = 0; river < static_cast<int>(lods.size()); river++)
+	{
+		int level = lods[river].SelectLevel(worldToScreen, screenSize, tolerancePixels);
+		if (level == -1)
+			continue;
+
+		drawFirsts.push_back(levelFirsts[firstLevels[river] + level]);
+		drawCounts.push_back(levelCounts[firstLevels[river] + level]);
+	}
+}
+
+void RiverBatch::Upload()
+{
+	if (!VAO)
+	{
+		glGenVertexArrays(1, &VAO);
+		glGenBuffers(1, &buffer);
+
+		RenderState::BindVertexArray(VAO);
+		glBindBuffer(GL_ARRAY_BUFFER, buffer);
+
+		// Same locations as VertexFormat
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(RiverVertex), 0);
+
+		glEnableVertexAttribArray(2);
+		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(RiverVertex), (void*)(sizeof(glm::vec3)));
+
+		RenderState::BindVertexArray(0);
+	}
+
+	// A single update, the storage is only reallocated when the arena grows
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	if (arena.size() > bufferCapacity)
+	{
+		bufferCapacity = arena.size();
+		glBufferData(GL_ARRAY_BUFFER, bufferCapacity * sizeof(RiverVertex), arena.data(), GL_DYNAMIC_DRAW);
+	}
+	else if (!arena.empty())
+	{
+		glBufferSubData(GL_ARRAY_BUFFER, 0, arena.size() * sizeof(RiverVertex), arena.data());
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	CheckOpenGLError();
+}
+
+void RiverBatch::Draw() const
+{
+	if (!VAO || drawCounts.empty())
+		return;
+
+	RenderState::BindVertexArray(VAO);
+	glMultiDrawArrays(GL_TRIANGLE_STRIP, drawFirsts.data(), drawCounts.data(), static_cast<GLsizei>(drawCounts.size()));
+}
+
+int RiverBatch::GetVertexCount() const
+{
+	return static_cast<int>(arena.size());
+}
+
+int RiverBatch::GetDrawnVertexCount() const
+{
+	int count = 0;
+	for (GLsizei vertices : drawCounts)
+		count += vertices;
+	return count;
+}
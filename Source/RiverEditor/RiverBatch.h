@@ -0,0 +1,75 @@
+#pragma once
+
+#include <vector>
+
+#include <include/gl.h>
+
+#include "SegmentTessellator.h"
+#include "RiverLOD.h"
+
+class WorkStealingPool;
+
+// Many independent rivers tessellated together into a single vertex arena.
+// The rivers are tessellated in parallel on a work-stealing pool, each one writes
+// its own part of the arena, so the whole batch is uploaded with one buffer update
+// and drawn with one glMultiDrawArrays call.
+// With levels of detail the arena holds every level of every river, uploaded once,
+// and each frame only picks the strip of each river that fits its size on screen.
+class RiverBatch
+{
+public:
+	RiverBatch();
+	~RiverBatch();
+
+	// The splines must stay alive and unchanged while the batch uses them
+	void SetRivers(const std::vector<const Spline*> &rivers);
+	int GetRiversCount() const;
+
+	// CPU part, fills the arena using every worker of the pool
+	void Tessellate(WorkStealingPool &pool, const RiverMeshSettings &settings);
+
+	// Builds the levels of detail of every river into the arena, tolerances are in world units
+	void BuildLevels(WorkStealingPool &pool, const RiverMeshSettings &settings, int levelsCount, float baseTolerance);
+
+	// Picks the level of each river, rivers outside the screen are skipped
+	void SelectLevels(const glm::mat4 &worldToScreen, const glm::vec2 &screenSize, float tolerancePixels);
+
+	// Sends the whole arena to the GPU
+	void Upload();
+
+	void Draw() const;
+
+	int GetVertexCount() const;
+
+	// Vertices sent by the next Draw()
+	int GetDrawnVertexCount() const;
+
+private:
+	std::vector<const Spline*> rivers;
+
+	// Index of the first segment of each river in the batch, the last entry is the total
+	std::vector<int> firstSegments;
+
+	// One strip for each segment of every river
+	std::vector<GLint> firsts;
+	std::vector<GLsizei> counts;
+	std::vector<RiverVertex> arena;
+
+	// Levels of detail, the strip of a level is at levelFirsts[firstLevels[river] + level]
+	// Rivers may have different levels counts, the last entry of firstLevels is the total
+	std::vector<RiverLOD> lods;
+	std::vector<int> firstLevels;
+	std::vector<GLint> levelFirsts;
+	std::vector<GLsizei> levelCounts;
+
+	// Strips drawn by Draw()
+	std::vector<GLint> drawFirsts;
+	std::vector<GLsizei> drawCounts;
+
+	// One for each worker, they hold the scratch memory
+	std::vector<SegmentTessellator> tessellators;
+
+	GLuint VAO;
+	GLuint buffer;
+	size_t bufferCapacity;
+};
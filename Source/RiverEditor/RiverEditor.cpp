@@ -1,5 +1,9 @@
 #include "RiverEditor.h"
 #include "Utils.h"
+#include "Benchmark.h"
+#include <Core/GPU/CameraUniforms.h>
+#include <Core/GPU/RenderState.h>
+#include <Core/GPU/GPUProfiler.h>
 
 #include <vector>
 #include <iostream>
@@ -7,7 +11,12 @@
 void RiverEditor::DefaultParameters()
 {
 	// River control
-	controlPointsCount = 4;
+	longRiverPointsCount = 2048;
+	riverNetworkSize = glm::ivec2(256, 64);
+	riverNetworkOn = false;
+	riverNetworkValid = false;
+	riverNetworkLevels = 6;
+	riverNetworkBaseTolerance = 0.05f;
 	smoothness = 0.5f;
 	animationSpeed = 0.1f;
 	tilingFactor = 5.0f; 
@@ -19,19 +28,38 @@ void RiverEditor::DefaultParameters()
 	// Camera
 	aspectRatio = glm::vec2(16.0f, 9.0f);
 	viewDistance = 100.0f;
+	zoomLevel = 1.0f;
+	zoomLimits = glm::vec2(0.1f, 10.0f);
 
 	// Mouse picking
 	clickDistanceThreshold = 0.4f;
 	selection = -1;
+	strokeTolerance = 2.0f;
 
 	// Curve generation
 	instanceCount = 1;
 	generatedPoints = 30;
+	generatedPointsLimits = glm::ivec2(2, 4096);
 	riverWidth = 0.75f;
+	widthFactorLimits = glm::vec2(0.1f, 4.0f);
+	tessellationMode = TESSELLATION_ADAPTIVE;
+	flatnessTolerance = 0.5f;
+	tessellationEdgeLength = 8.0f;
+	riverRenderPath = RIVER_PATH_CACHED_MESH;
 
 	// Post processing
 	postProcessOn = true;
 	waveEffectFrequency = 16.0f;
+	bloomThreshold = 0.7f;
+	bloomIntensity = 1.0f;
+	bloomLevels = 5;
+	blurLevels = 2;
+	blurKernel = BLUR_KERNEL_GAUSSIAN;
+	blurRadius = 8;
+
+	// Dynamic resolution
+	frameBudget = 1000.0f / 60.0f;
+	resolutionScaleLimits = glm::vec2(0.5f, 1.0f);
 }
 
 void RiverEditor::Init()
@@ -40,12 +68,21 @@ void RiverEditor::Init()
 
 	// Default rendering mode will use depth buffer
 	glDepthMask(GL_TRUE);
-	glEnable(GL_DEPTH_TEST);
+	RenderState::Invalidate();
+	RenderState::SetDepthTest(true);
 
 	// Init frame buffer
 	glm::vec2 resolution = window->GetResolution();
 	frameBuffer = std::unique_ptr<FrameBuffer>(new FrameBuffer());
-	frameBuffer->Generate(resolution.x, resolution.y, 2);
+	frameBuffer->Generate(resolution.x, resolution.y, 1, true, 16);
+	frameBuffer->GetTexture(0)->SetWrappingMode(GL_CLAMP_TO_EDGE);
+
+	// Bloom and blur start at half resolution
+	postProcessGraph.Generate(resolution, bloomLevels);
+
+	// Off until toggled, the scene is then drawn at the scale that fits the budget
+	dynamicResolution.SetBudget(frameBudget);
+	dynamicResolution.SetScaleLimits(resolutionScaleLimits.x, resolutionScaleLimits.y);
 
 	// Camera setup --------------------------------------------------------------
 	camera = std::unique_ptr<EngineComponents::Camera>(new EngineComponents::Camera());
@@ -56,11 +93,18 @@ void RiverEditor::Init()
 	camera->Update();
 
 	// Control points ------------------------------------------------------------
+	std::vector<glm::vec3> controlPoints;
 	controlPoints.push_back(glm::vec3(-aspectRatio.x / 2.0f + 1.0f, 0.0f, 0.0f));
 	controlPoints.push_back(glm::vec3(0.0f, aspectRatio.y / 2.0f - 1.0f, 0.0f));
 	controlPoints.push_back(glm::vec3(0.0f, -aspectRatio.y / 2.0f + 1.0f, 0.0f));
 	controlPoints.push_back(glm::vec3(aspectRatio.x / 2.0f - 1.0f, 0.0f, 0.0f));
 
+	river = std::unique_ptr<River>(new River());
+	river->GetSpline().SetControlPoints(controlPoints);
+
+	// One worker for each hardware thread
+	tessellationPool = std::unique_ptr<WorkStealingPool>(new WorkStealingPool());
+
 	// Quad mesh -----------------------------------------------------------------
 	{
 		std::vector<VertexFormat> vertices =
@@ -81,28 +125,28 @@ void RiverEditor::Init()
 		meshes["quad"]->InitFromData(vertices, indices);
 	}
 
-	// River mesh ----------------------------------------------------------------
+	// Default Shader ------------------------------------------------------------
 	{
-		std::vector<VertexFormat> vertices =
-		{
-			VertexFormat(controlPoints[0], glm::vec3(0, 1, 0)),
-			VertexFormat(controlPoints[controlPointsCount - 1], glm::vec3(0, 1, 0))
-		};
-
-		std::vector<unsigned short> indices =
-		{
-			0, 1
-		};
+		Shader *shader = new Shader("Simple");
+		shader->AddShader(RESOURCE_PATH::SHADERS + "RiverEditor/Simple.VS.glsl", GL_VERTEX_SHADER);
+		shader->AddShader(RESOURCE_PATH::SHADERS + "RiverEditor/Simple.FS.glsl", GL_FRAGMENT_SHADER);
+		shader->CreateAndLink();
+		shaders[shader->GetName()] = std::shared_ptr<Shader>(shader);
+	}
 
-		meshes["river"] = std::shared_ptr<Mesh>(new Mesh("generated initial surface points"));
-		meshes["river"]->InitFromData(vertices, indices);
-		meshes["river"]->SetDrawMode(GL_LINES);
+	// Render Queue Shader -------------------------------------------------------
+	{
+		Shader *shader = new Shader("Queued");
+		shader->AddShader(RESOURCE_PATH::SHADERS + "RiverEditor/Queued.VS.glsl", GL_VERTEX_SHADER);
+		shader->AddShader(RESOURCE_PATH::SHADERS + "RiverEditor/Simple.FS.glsl", GL_FRAGMENT_SHADER);
+		shader->CreateAndLink();
+		shaders[shader->GetName()] = std::shared_ptr<Shader>(shader);
 	}
 
-	// Default Shader ------------------------------------------------------------
+	// Gizmo Shader ------------------------------------------------------------------
 	{
-		Shader *shader = new Shader("Simple");
-		shader->AddShader(RESOURCE_PATH::SHADERS + "RiverEditor/Simple.VS.glsl", GL_VERTEX_SHADER);
+		Shader *shader = new Shader("Gizmo");
+		shader->AddShader(RESOURCE_PATH::SHADERS + "RiverEditor/Gizmo.VS.glsl", GL_VERTEX_SHADER);
 		shader->AddShader(RESOURCE_PATH::SHADERS + "RiverEditor/Simple.FS.glsl", GL_FRAGMENT_SHADER);
 		shader->CreateAndLink();
 		shaders[shader->GetName()] = std::shared_ptr<Shader>(shader);
@@ -118,6 +162,53 @@ void RiverEditor::Init()
 		shaders[shader->GetName()] = std::shared_ptr<Shader>(shader);
 	}	
 
+	// River Network Shader ------------------------------------------------------
+	{
+		Shader *shader = new Shader("RiverNetwork");
+		shader->AddShader(RESOURCE_PATH::SHADERS + "RiverEditor/RiverNetwork.VS.glsl", GL_VERTEX_SHADER);
+		shader->AddShader(RESOURCE_PATH::SHADERS + "RiverEditor/Bezier.GS.glsl", GL_GEOMETRY_SHADER);
+		shader->AddShader(RESOURCE_PATH::SHADERS + "RiverEditor/Simple.FS.glsl", GL_FRAGMENT_SHADER);
+		shader->CreateAndLink();
+		shaders[shader->GetName()] = std::shared_ptr<Shader>(shader);
+	}
+
+	// Curve Tessellation Shader -------------------------------------------------
+	{
+		Shader *shader = new Shader("BezierPatch");
+		shader->AddShader(RESOURCE_PATH::SHADERS + "RiverEditor/Pass.VS.glsl", GL_VERTEX_SHADER);
+		shader->AddTessellationShaders(RESOURCE_PATH::SHADERS + "RiverEditor/Bezier.TCS.glsl",
+										RESOURCE_PATH::SHADERS + "RiverEditor/Bezier.TES.glsl", 4);
+		shader->AddShader(RESOURCE_PATH::SHADERS + "RiverEditor/Simple.FS.glsl", GL_FRAGMENT_SHADER);
+		shader->CreateAndLink();
+		shaders[shader->GetName()] = std::shared_ptr<Shader>(shader);
+	}
+
+	// River Shader ------------------------------------------------------------
+	{
+		Shader *shader = new Shader("River");
+		shader->AddShader(RESOURCE_PATH::SHADERS + "RiverEditor/River.VS.glsl", GL_VERTEX_SHADER);
+		shader->AddShader(RESOURCE_PATH::SHADERS + "RiverEditor/Simple.FS.glsl", GL_FRAGMENT_SHADER);
+		shader->CreateAndLink();
+		shaders[shader->GetName()] = std::shared_ptr<Shader>(shader);
+	}
+
+	// River Tessellation Shader -------------------------------------------------
+	{
+		Shader *shader = new Shader("RiverTessellation");
+		shader->AddShader(RESOURCE_PATH::SHADERS + "RiverEditor/RiverTessellation.CS.glsl", GL_COMPUTE_SHADER);
+		shader->CreateAndLink();
+		shaders[shader->GetName()] = std::shared_ptr<Shader>(shader);
+	}
+
+	// River Vertex Pulling Shader -----------------------------------------------
+	{
+		Shader *shader = new Shader("RiverPull");
+		shader->AddShader(RESOURCE_PATH::SHADERS + "RiverEditor/RiverPull.VS.glsl", GL_VERTEX_SHADER);
+		shader->AddShader(RESOURCE_PATH::SHADERS + "RiverEditor/Simple.FS.glsl", GL_FRAGMENT_SHADER);
+		shader->CreateAndLink();
+		shaders[shader->GetName()] = std::shared_ptr<Shader>(shader);
+	}
+
 	// Particle Shader -----------------------------------------------------------
 	{
 		Shader *shader = new Shader("Particle");
@@ -128,36 +219,53 @@ void RiverEditor::Init()
 		shaders[shader->GetName()] = std::shared_ptr<Shader>(shader);
 	}
 
-	// Bloom Shader --------------------------------------------------------------
+	// Bloom Downsample Shader ---------------------------------------------------
 	{
-		Shader *shader = new Shader("Bloom");
-		shader->AddShader(RESOURCE_PATH::SHADERS + "RiverEditor/Simple.VS.glsl", GL_VERTEX_SHADER);
-		shader->AddShader(RESOURCE_PATH::SHADERS + "RiverEditor/Bloom.FS.glsl", GL_FRAGMENT_SHADER);
+		Shader *shader = new Shader("BloomDown");
+		shader->AddShader(RESOURCE_PATH::SHADERS + "RiverEditor/Screen.VS.glsl", GL_VERTEX_SHADER);
+		shader->AddShader(RESOURCE_PATH::SHADERS + "RiverEditor/BloomDown.FS.glsl", GL_FRAGMENT_SHADER);
 		shader->CreateAndLink();
 		shaders[shader->GetName()] = std::shared_ptr<Shader>(shader);
-		postProcessFX.push_back(shader->GetName());
 	}
 
-	// Blur Shader ---------------------------------------------------------------
+	// Bloom Upsample Shader -----------------------------------------------------
 	{
-		Shader *shader = new Shader("Blur");
-		shader->AddShader(RESOURCE_PATH::SHADERS + "RiverEditor/Simple.VS.glsl", GL_VERTEX_SHADER);
-		shader->AddShader(RESOURCE_PATH::SHADERS + "RiverEditor/Blur.FS.glsl", GL_FRAGMENT_SHADER);
+		Shader *shader = new Shader("BloomUp");
+		shader->AddShader(RESOURCE_PATH::SHADERS + "RiverEditor/Screen.VS.glsl", GL_VERTEX_SHADER);
+		shader->AddShader(RESOURCE_PATH::SHADERS + "RiverEditor/BloomUp.FS.glsl", GL_FRAGMENT_SHADER);
 		shader->CreateAndLink();
 		shaders[shader->GetName()] = std::shared_ptr<Shader>(shader);
-		postProcessFX.push_back(shader->GetName());
 	}
 
-	// Wave Shader ---------------------------------------------------------------
+	// Box Blur Shader -----------------------------------------------------------
 	{
-		Shader *shader = new Shader("Wave");
-		shader->AddShader(RESOURCE_PATH::SHADERS + "RiverEditor/Simple.VS.glsl", GL_VERTEX_SHADER);
-		shader->AddShader(RESOURCE_PATH::SHADERS + "RiverEditor/Wave.FS.glsl", GL_FRAGMENT_SHADER);
+		Shader *shader = new Shader("BoxBlur");
+		shader->AddShader(RESOURCE_PATH::SHADERS + "RiverEditor/Blur.CS.glsl", GL_COMPUTE_SHADER);
+		shader->CreateAndLink();
+		shaders[shader->GetName()] = std::shared_ptr<Shader>(shader);
+	}
+
+	// Kawase Blur Shader --------------------------------------------------------
+	{
+		Shader *shader = new Shader("KawaseBlur");
+		shader->AddShader(RESOURCE_PATH::SHADERS + "RiverEditor/Kawase.CS.glsl", GL_COMPUTE_SHADER);
+		shader->CreateAndLink();
+		shaders[shader->GetName()] = std::shared_ptr<Shader>(shader);
+	}
+
+	// Post Processing Shader ----------------------------------------------------
+	{
+		Shader *shader = new Shader("PostProcess");
+		shader->AddShader(RESOURCE_PATH::SHADERS + "RiverEditor/Screen.VS.glsl", GL_VERTEX_SHADER);
+		shader->AddShader(RESOURCE_PATH::SHADERS + "RiverEditor/PostProcess.FS.glsl", GL_FRAGMENT_SHADER);
 		shader->CreateAndLink();
 		shaders[shader->GetName()] = std::shared_ptr<Shader>(shader);
-		postProcessFX.push_back(shader->GetName());
 	}
 
+	// Use the best river tessellation the GPU can do
+	riverRenderPath = SelectRenderPath();
+	std::cout << "River render path: " << GetRenderPathName(riverRenderPath) << std::endl;
+
 	// Water Texture -------------------------------------------------------------
 	TextureManager::LoadTexture(RESOURCE_PATH::TEXTURES + "RiverEditor", "water.png", "water");
 
@@ -179,16 +287,42 @@ void RiverEditor::Init()
 	UpdateVFX();
 
 	// PostProcessing stuff ------------------------------------------------------
+	PostProcessGraph::Shaders postProcessShaders;
+	postProcessShaders.composite = shaders["PostProcess"].get();
+	postProcessShaders.bloomDown = shaders["BloomDown"].get();
+	postProcessShaders.bloomUp = shaders["BloomUp"].get();
+	postProcessShaders.boxBlur = shaders["BoxBlur"].get();
+	postProcessShaders.kawaseBlur = shaders["KawaseBlur"].get();
+	postProcessGraph.Init(meshes["quad"].get(), postProcessShaders);
+
+	// Cycled with SPACE, the first three are the single effects
+	postProcessChains.push_back({ POST_EFFECT_BLOOM });
+	postProcessChains.push_back({ POST_EFFECT_BLUR });
+	postProcessChains.push_back({ POST_EFFECT_WAVE });
+	postProcessChains.push_back({ POST_EFFECT_BLOOM, POST_EFFECT_WAVE });
+	postProcessChains.push_back({ POST_EFFECT_BLUR, POST_EFFECT_BLOOM, POST_EFFECT_WAVE });
 	currentEffect = 0;
+	postProcessGraph.SetEffects(postProcessChains[currentEffect]);
 }
 
 void RiverEditor::FrameStart()
 {
+	RenderState::BeginFrame();
+	dynamicResolution.BeginFrame();
+
 	if (postProcessOn)
 	{
+		// Follows the window size and the dynamic resolution scale
+		glm::ivec2 resolution = dynamicResolution.GetResolution(window->GetResolution());
+		if (resolution != frameBuffer->GetResolution())
+			ResizeFrameBuffer(resolution);
+
 		frameBuffer->Bind();
 	}
-	ClearScreen();
+	else
+	{
+		ClearScreen();
+	}
 }
 
 void RiverEditor::Update(float deltaTimeSeconds)
@@ -196,19 +330,39 @@ void RiverEditor::Update(float deltaTimeSeconds)
 	glm::vec3 planeOffset = glm::vec3(0.0f, 0.0f, 0.1f);
 
 	// Render control points gizmos
-	glm::vec3 controlPointScale = glm::vec3(clickDistanceThreshold * 2.0 / sqrt(2.0f));
-	Texture2D *texture = TextureManager::GetTexture("button");
-	for (auto &point : controlPoints)
+	float controlPointScale = clickDistanceThreshold * 2.0f / sqrt(2.0f);
+	const std::vector<glm::vec3> &controlPoints = river->GetSpline().GetControlPoints();
+	gizmos.Begin();
+	for (size_t i = 0; i < controlPoints.size(); i++)
 	{
-		RenderMesh(meshes["quad"], shaders["Simple"], texture, point + planeOffset, controlPointScale);
+		gizmos.Add(controlPoints[i] + planeOffset, controlPointScale, static_cast<int>(i) == selection);
 	}
 
+	// Highlight the river under the mouse
+	if (hover.segment != -1)
+	{
+		gizmos.Add(hover.position + planeOffset, controlPointScale / 2.0f);
+	}
+
+	Texture2D *texture = TextureManager::GetTexture("button");
+	RenderGizmos(texture);
+
 	// Render background
-	texture = TextureManager::GetTexture("background");
-	RenderMesh(meshes["quad"], shaders["Simple"], texture, -planeOffset, glm::vec3(aspectRatio.x, aspectRatio.y, 0.0f));
+	glm::mat4 backgroundModel = glm::translate(glm::mat4(1), -planeOffset);
+	backgroundModel = glm::scale(backgroundModel, glm::vec3(aspectRatio.x, aspectRatio.y, 0.0f));
+	renderQueue.Submit(meshes["quad"].get(), shaders["Queued"].get(), TextureManager::GetTexture("background"), backgroundModel);
 
 	// Render river curve
-	RenderRiver(TextureManager::GetTexture("water"));
+	if (riverNetworkOn)
+		RenderRiverNetwork(TextureManager::GetTexture("water"));
+	else
+		RenderRiver(TextureManager::GetTexture("water"));
+
+	// The VFX are blended over everything drawn so far
+	{
+		GPUProfiler::Scope scope("Background");
+		renderQueue.Flush(camera.get());
+	}
 
 	// Render river vfx depending on the speed
 	if (animationSpeed > 0.0f)
@@ -216,8 +370,30 @@ void RiverEditor::Update(float deltaTimeSeconds)
 		// Small offset so we keep vfx bounded in the river
 		float offset = 0.025f;
 
-		for (float t = offset; t <= 1; t += 1.0 / animationSpeed)
-			RenderVFX(splashEffect, shaders["Particle"], GetBezierPoint(t), deltaTimeSeconds);
+		// Emitters are spaced by distance along the river, not by the curve parameter
+		const Spline &spline = river->GetSpline();
+		float length = spline.GetLength();
+		emitterParameters.clear();
+		for (float s = offset; s <= 1; s += 1.0 / animationSpeed)
+			emitterParameters.push_back(spline.GetParameterAtLength(s * length));
+
+		// Evaluate all the emitter positions in a single batch
+		emitterPositions.resize(emitterParameters.size());
+		spline.Evaluate(emitterParameters.data(), static_cast<unsigned int>(emitterParameters.size()),
+						emitterPositions.data());
+
+		// Additive blending without depth for all the emitters
+		GPUProfiler::Scope scope("VFX");
+		RenderState::SetBlend(true);
+		RenderState::SetDepthTest(false);
+		RenderState::SetBlendFunc(GL_ONE, GL_ONE);
+		RenderState::SetBlendEquation(GL_FUNC_ADD);
+
+		for (auto &position : emitterPositions)
+			RenderVFX(splashEffect, shaders["Particle"], position, deltaTimeSeconds);
+
+		RenderState::SetDepthTest(true);
+		RenderState::SetBlend(false);
 	}
 }
 
@@ -225,19 +401,21 @@ void RiverEditor::FrameEnd()
 {
 	if (postProcessOn)
 	{
-		FrameBuffer::BindDefault();
-		ClearScreen();
-
-		ApplyPostProcessing(shaders[postProcessFX[currentEffect]]);
+		ApplyPostProcessing();
 	}
+
+	dynamicResolution.EndFrame();
 }
 
 void RiverEditor::RenderMesh(std::shared_ptr<Mesh> &mesh, std::shared_ptr<Shader> &shader, Texture2D *texture,
-									const glm::vec3 &position, const glm::vec3 &scale)
+									const glm::vec3 &position, const glm::vec3 &scale, EngineComponents::Camera *viewCamera)
 {
 	if (!mesh || !shader || !shader->program)
 		return;
 
+	if (!viewCamera)
+		viewCamera = camera.get();
+
 	shader->Use();
 
 	// Build Model
@@ -248,9 +426,8 @@ void RiverEditor::RenderMesh(std::shared_ptr<Mesh> &mesh, std::shared_ptr<Shader
 	// Send model to shader
 	glUniformMatrix4fv(shader->loc_model_matrix, 1, GL_FALSE, glm::value_ptr(model));
 
-	// Send View & Projection to shader
-	glUniformMatrix4fv(shader->loc_view_matrix, 1, GL_FALSE, glm::value_ptr(camera->GetViewMatrix()));
-	glUniformMatrix4fv(shader->loc_projection_matrix, 1, GL_FALSE, glm::value_ptr(camera->GetProjectionMatrix()));
+	// View & Projection, uploaded only when the camera changed
+	CameraUniforms::Set(viewCamera);
 
 	// Apply textures if needed
 	if (texture)
@@ -266,114 +443,326 @@ void RiverEditor::RenderMesh(std::shared_ptr<Mesh> &mesh, std::shared_ptr<Shader
 
 	// Render mesh with textures
 	mesh->Render();
-
-	if (texture)
-		texture->UnBind();
 }
 
 void RiverEditor::RenderRiver(Texture2D *texture)
 {
-	auto mesh = meshes["river"];
-	auto shader = shaders["BezierCurve"];
-	if (!mesh || !shader || !shader->GetProgramID() || !texture)
+	if (!river || !texture)
 		return;
 
-	shader->Use();
+	GPUProfiler::Scope scope("River");
 
-	// Send model to shader
-	glUniformMatrix4fv(shader->loc_model_matrix, 1, GL_FALSE, glm::value_ptr(glm::mat4(1)));
+	// Only the segments modified since the last frame are sent
+	river->UploadSegments();
 
-	// Send View & Projection to shader
-	glUniformMatrix4fv(shader->loc_view_matrix, 1, GL_FALSE, glm::value_ptr(camera->GetViewMatrix()));
-	glUniformMatrix4fv(shader->loc_projection_matrix, 1, GL_FALSE, glm::value_ptr(camera->GetProjectionMatrix()));
+	if (riverRenderPath == RIVER_PATH_CACHED_MESH)
+	{
+		RenderRiverMesh(texture);
+		return;
+	}
 
-	// Send control points
-	for (int i = 0; i < controlPointsCount; i++)
+	if (riverRenderPath == RIVER_PATH_COMPUTE_SHADER)
 	{
-		std::string name = "control_points[" + std::to_string(i) + "]";
-		int loc = glGetUniformLocation(shader->program, name.c_str());
-		glUniform3fv(loc, 1, glm::value_ptr(controlPoints[i]));
+		RenderRiverCompute(texture);
+		return;
 	}
 
+	// Geometry and tessellation shaders build the same surface from the segment points
+	bool usePatches = riverRenderPath == RIVER_PATH_TESSELLATION_SHADER;
+	auto shader = usePatches ? shaders["BezierPatch"] : shaders["BezierCurve"];
+	if (!shader || !shader->GetProgramID())
+		return;
+
+	shader->Use();
+	SendRiverParameters(shader, instanceCount);
+
+	// Texture
+	texture->BindToTextureUnit(GL_TEXTURE0);
+	glUniform1i(shader->loc_textures[0], 0);
+
+	// Draw the segments instanced
+	if (usePatches)
+		river->DrawPatches(instanceCount);
+	else
+		river->Draw(instanceCount);
+}
+
+void RiverEditor::SendRiverParameters(std::shared_ptr<Shader> &shader, int instancesCount)
+{
+	// Send model to shader
+	glUniformMatrix4fv(shader->loc_model_matrix, 1, GL_FALSE, glm::value_ptr(glm::mat4(1)));
+
+	// View & Projection, uploaded only when the camera changed
+	CameraUniforms::Set(camera.get());
+
 	// Send other parameters
-	int loc = glGetUniformLocation(shader->program, "generated_points_count");
-	glUniform1i(loc, generatedPoints);
-	loc = glGetUniformLocation(shader->program, "surface_width");
-	glUniform1f(loc, riverWidth);
-	loc = glGetUniformLocation(shader->program, "no_of_instances");
-	glUniform1i(loc, instanceCount);
+	shader->SetUniform("generated_points_count", generatedPoints);
+	shader->SetUniform("surface_width", riverWidth);
+	shader->SetUniform("no_of_instances", instancesCount);
+
+	// Tessellation
+	shader->SetUniform("tessellation_mode", static_cast<int>(tessellationMode));
+	shader->SetUniform("flatness_tolerance", flatnessTolerance);
+	shader->SetUniform("screen_size", window->GetResolution());
+	shader->SetUniform("pixels_per_edge", tessellationEdgeLength);
 
 	// River flow
-	loc = glGetUniformLocation(shader->program, "time");
-	glUniform1f(loc, Engine::GetElapsedTime());
-	loc = glGetUniformLocation(shader->program, "speed");
-	glUniform1f(loc, animationSpeed);
-	loc = glGetUniformLocation(shader->program, "tilingFactor");
-	glUniform1f(loc, tilingFactor);
+	shader->SetUniform("time", static_cast<float>(Engine::GetElapsedTime()));
+	shader->SetUniform("speed", animationSpeed);
+	shader->SetUniform("tilingFactor", tilingFactor);
+}
+
+void RiverEditor::RenderRiverMesh(Texture2D *texture)
+{
+	auto shader = shaders["River"];
+	if (!shader || !shader->GetProgramID())
+		return;
+
+	// Nothing is tessellated unless the river or its parameters changed
+	river->UpdateMesh(GetRiverMeshSettings());
+
+	shader->Use();
+
+	// View & Projection, uploaded only when the camera changed
+	CameraUniforms::Set(camera.get());
+
+	// River flow is only a texture offset
+	shader->SetUniform("flow_offset", animationSpeed * static_cast<float>(Engine::GetElapsedTime()));
 
 	// Texture
 	texture->BindToTextureUnit(GL_TEXTURE0);
 	glUniform1i(shader->loc_textures[0], 0);
 
-	// Draw the object instanced
-	glBindVertexArray(mesh->GetBuffers()->VAO);
-	glDrawElementsInstanced(mesh->GetDrawMode(), static_cast<int>(mesh->indices.size()), GL_UNSIGNED_INT, (void*)0, instanceCount);
-	glBindVertexArray(0);
+	river->DrawMesh();
+}
+
+void RiverEditor::RenderRiverCompute(Texture2D *texture)
+{
+	auto computeShader = shaders["RiverTessellation"];
+	auto shader = shaders["RiverPull"];
+	if (!computeShader || !computeShader->GetProgramID() || !shader || !shader->GetProgramID())
+		return;
+
+	// Only the dirty segments are dispatched
+	river->UpdateComputeMesh(computeShader.get(), GetRiverMeshSettings());
+
+	shader->Use();
+
+	// View & Projection, uploaded only when the camera changed
+	CameraUniforms::Set(camera.get());
+
+	// River flow is only a texture offset
+	shader->SetUniform("flow_offset", animationSpeed * static_cast<float>(Engine::GetElapsedTime()));
+
+	// Texture
+	texture->BindToTextureUnit(GL_TEXTURE0);
+	glUniform1i(shader->loc_textures[0], 0);
 
-	texture->UnBind();
+	river->DrawComputeMesh(shader.get());
 }
 
-void RiverEditor::RenderVFX(std::unique_ptr< ParticleEffect<Particle> > &effect, std::shared_ptr<Shader> &shader,
-								const glm::vec3 &position, float deltaTime)
+const char* RiverEditor::GetRenderPathName(RiverRenderPath path)
 {
-	if (!effect || !shader || !shader->program)
+	switch (path)
+	{
+	case RIVER_PATH_CACHED_MESH:
+		return "cached mesh";
+	case RIVER_PATH_GEOMETRY_SHADER:
+		return "geometry shader";
+	case RIVER_PATH_COMPUTE_SHADER:
+		return "compute shader";
+	case RIVER_PATH_TESSELLATION_SHADER:
+		return "tessellation shader";
+	default:
+		return "unknown";
+	}
+}
+
+bool RiverEditor::IsRenderPathSupported(RiverRenderPath path)
+{
+	switch (path)
+	{
+	case RIVER_PATH_CACHED_MESH:
+		return shaders["River"]->GetProgramID() != 0;
+	case RIVER_PATH_GEOMETRY_SHADER:
+		return shaders["BezierCurve"]->GetProgramID() != 0;
+	case RIVER_PATH_COMPUTE_SHADER:
+		return GLEW_ARB_compute_shader && GLEW_ARB_shader_storage_buffer_object &&
+				shaders["RiverTessellation"]->GetProgramID() && shaders["RiverPull"]->GetProgramID();
+	case RIVER_PATH_TESSELLATION_SHADER:
+		return GLEW_ARB_tessellation_shader && shaders["BezierPatch"]->GetProgramID();
+	default:
+		return false;
+	}
+}
+
+RiverRenderPath RiverEditor::SelectRenderPath()
+{
+	// Compute only runs for edited segments, the others tessellate every frame
+	const RiverRenderPath preferred[] =
+	{
+		RIVER_PATH_COMPUTE_SHADER,
+		RIVER_PATH_TESSELLATION_SHADER,
+		RIVER_PATH_GEOMETRY_SHADER
+	};
+
+	for (RiverRenderPath path : preferred)
+	{
+		if (IsRenderPathSupported(path))
+			return path;
+	}
+	return RIVER_PATH_CACHED_MESH;
+}
+
+void RiverEditor::RenderRiverNetwork(Texture2D *texture)
+{
+	GPUProfiler::Scope scope("River network");
+
+	if (riverRenderPath == RIVER_PATH_GEOMETRY_SHADER)
+	{
+		RenderRiverNetworkInstanced(texture);
 		return;
+	}
 
-	// Magic shit
-	glEnable(GL_BLEND);
-	glDisable(GL_DEPTH_TEST);
-	glBlendFunc(GL_ONE, GL_ONE);
-	glBlendEquation(GL_FUNC_ADD);
+	auto shader = shaders["River"];
+	if (!shader || !shader->GetProgramID() || !texture)
+		return;
 
-	// Modify the effect's transform and then Render it 
-	effect->source->SetWorldPosition(position);
-	effect->Render(camera.get(), shader.get(), deltaTime);
+	// The levels of detail are built from a uniform tessellation and don't depend on the camera,
+	// so the network is rebuilt only when the shape parameters change
+	RiverMeshSettings settings = GetRiverMeshSettings();
+	settings.mode = TESSELLATION_UNIFORM;
+	if (!riverNetworkValid || settings != riverNetworkSettings)
+	{
+		riverNetwork.BuildLevels(*tessellationPool, settings, riverNetworkLevels, riverWidth * riverNetworkBaseTolerance);
+		riverNetwork.Upload();
+		riverNetworkSettings = settings;
+		riverNetworkValid = true;
+	}
+
+	// Every frame only picks the coarsest level that keeps the error under the flatness tolerance
+	riverNetwork.SelectLevels(settings.worldToScreen, window->GetResolution(), flatnessTolerance);
 
-	// Stop da magic
-	glEnable(GL_DEPTH_TEST);
-	glDisable(GL_BLEND);
+	shader->Use();
+
+	// View & Projection, uploaded only when the camera changed
+	CameraUniforms::Set(camera.get());
+
+	shader->SetUniform("flow_offset", animationSpeed * static_cast<float>(Engine::GetElapsedTime()));
+
+	// Texture
+	texture->BindToTextureUnit(GL_TEXTURE0);
+	glUniform1i(shader->loc_textures[0], 0);
+
+	riverNetwork.Draw();
 }
 
-void RiverEditor::ApplyPostProcessing(std::shared_ptr<Shader> &shader)
+void RiverEditor::RenderGizmos(Texture2D *texture)
 {
-	if (!shader || !shader->program)
+	auto shader = shaders["Gizmo"];
+	if (!shader || !shader->GetProgramID() || !texture)
 		return;
 
+	GPUProfiler::Scope scope("Gizmos");
+
+	gizmos.Upload();
+
 	shader->Use();
 
-	// Send screen resolution to shader
-	int loc = glGetUniformLocation(shader->program, "screen_size");
-	glUniform2iv(loc, 1, glm::value_ptr(window->GetResolution()));
+	// View & Projection, uploaded only when the camera changed
+	CameraUniforms::Set(camera.get());
 
-	// Send time to shader
-	loc = glGetUniformLocation(shader->program, "time");
-	glUniform1f(loc, Engine::GetElapsedTime());
+	texture->BindToTextureUnit(GL_TEXTURE0);
+	glUniform1i(shader->loc_textures[0], 0);
 
-	// Other params
-	loc = glGetUniformLocation(shader->program, "frequency");
-	glUniform1f(loc, waveEffectFrequency);
+	gizmos.Draw();
+}
 
-	// Send the secondary textures to GPU
-	Texture2D *texture = frameBuffer->GetTexture(1);
-	texture->BindToTextureUnit(GL_TEXTURE1);
-	glUniform1i(shader->loc_textures[1], 1);
+void RiverEditor::RenderRiverNetworkInstanced(Texture2D *texture)
+{
+	auto shader = shaders["RiverNetwork"];
+	if (!shader || !shader->GetProgramID() || !texture)
+		return;
 
-	// Render the quad
-	texture = frameBuffer->GetTexture(0);
-	RenderMesh(meshes["quad"], shader, texture, glm::vec3(0), glm::vec3(aspectRatio.x, aspectRatio.y, 0.0f));
+	// Only the slices of the rivers edited since the last frame are sent
+	riverNetworkBuffer.UploadRivers();
 
-	// Unbind secondary textures
-	frameBuffer->GetTexture(1)->UnBind();
+	shader->Use();
+
+	// Every river is a single instance
+	SendRiverParameters(shader, 1);
+
+	texture->BindToTextureUnit(GL_TEXTURE0);
+	glUniform1i(shader->loc_textures[0], 0);
+
+	riverNetworkBuffer.Draw();
+}
+
+std::vector<const Spline*> RiverEditor::GetRiverNetwork() const
+{
+	std::vector<const Spline*> rivers;
+	for (auto &spline : networkRivers)
+		rivers.push_back(spline.get());
+	return rivers;
+}
+
+RiverMeshSettings RiverEditor::GetRiverMeshSettings() const
+{
+	RiverMeshSettings settings;
+	settings.mode = tessellationMode;
+	settings.pointsCount = generatedPoints;
+	settings.flatnessTolerance = flatnessTolerance;
+	settings.width = riverWidth;
+	settings.tilingFactor = tilingFactor;
+
+	// World to pixels, the same transform the geometry shader uses
+	glm::vec2 resolution = window->GetResolution();
+	glm::mat4 viewport = glm::scale(glm::mat4(1), glm::vec3(resolution / 2.0f, 1.0f));
+	viewport = glm::translate(viewport, glm::vec3(1.0f, 1.0f, 0.0f));
+	settings.worldToScreen = viewport * camera->GetProjectionMatrix() * camera->GetViewMatrix();
+
+	return settings;
+}
+
+void RiverEditor::RenderVFX(std::unique_ptr< ParticleEffect<Particle> > &effect, std::shared_ptr<Shader> &shader,
+								const glm::vec3 &position, float deltaTime)
+{
+	if (!effect || !shader || !shader->program)
+		return;
+
+	// Modify the effect's transform and then Render it 
+	effect->source->SetWorldPosition(position);
+	effect->Render(camera.get(), shader.get(), deltaTime);
+}
+
+void RiverEditor::ApplyPostProcessing()
+{
+	GPUProfiler::Scope scope("Post processing");
+
+	PostProcessGraph::Settings settings;
+	settings.bloomThreshold = bloomThreshold;
+	settings.bloomIntensity = bloomIntensity;
+	settings.bloomLevels = bloomLevels;
+	settings.computeBlur = IsComputeBlurSupported();
+	settings.blurKernel = blurKernel;
+	settings.blurRadius = blurRadius;
+	settings.blurLevels = blurLevels;
+	settings.waveFrequency = waveEffectFrequency;
+	settings.time = static_cast<float>(Engine::GetElapsedTime());
+
+	postProcessGraph.Render(frameBuffer->GetTexture(0), settings, window->GetResolution());
+}
+
+void RiverEditor::ResizeFrameBuffer(const glm::ivec2 &resolution)
+{
+	frameBuffer->Resize(resolution.x, resolution.y, 16);
+	postProcessGraph.Generate(resolution, bloomLevels);
+}
+
+bool RiverEditor::IsComputeBlurSupported()
+{
+	return GLEW_ARB_compute_shader && GLEW_ARB_shader_image_load_store &&
+			shaders["BoxBlur"]->GetProgramID() && shaders["KawaseBlur"]->GetProgramID();
 }
 
 void RiverEditor::UpdateVFX()
@@ -441,31 +830,107 @@ glm::vec3 RiverEditor::ScreenToWorldSpace(int x, int y)
 	return nearPlaneMousePos + t * pickRay;
 }
 
-glm::vec3 RiverEditor::GetBezierPoint(float t)
+void RiverEditor::UpdateStrokeRiver()
+{
+	Spline &spline = river->GetSpline();
+	const std::vector<glm::vec3> &points = stroke.GetControlPoints();
+	int first = stroke.GetFirstChangedPoint();
+
+	// New segments are added with their end point, the handles are moved below
+	int count = static_cast<int>(points.size());
+	while (spline.GetControlPointsCount() < count)
+		spline.AddControlPoint(points[spline.GetControlPointsCount() + 2]);
+
+	for (int i = first; i < count; i++)
+	{
+		if (spline.GetControlPoints()[i] != points[i])
+			spline.MoveControlPoint(i, points[i]);
+	}
+	stroke.ClearChanged();
+}
+
+void RiverEditor::GenerateLongRiver(int pointsCount)
+{
+	// Meander from left to right across the initial view
+	std::vector<glm::vec3> controlPoints(pointsCount);
+	float length = aspectRatio.x - 2.0f;
+	float amplitude = aspectRatio.y / 4.0f;
+	for (int i = 0; i < pointsCount; i++)
+	{
+		float x = -length / 2.0f + length * i / (pointsCount - 1);
+		float y = amplitude * sin(i * 0.35f) * cos(i * 0.0125f);
+		controlPoints[i] = glm::vec3(x, y, 0.0f);
+	}
+
+	river->GetSpline().SetControlPoints(controlPoints);
+	selection = -1;
+}
+
+void RiverEditor::GenerateRiverNetwork(int riversCount, int pointsCount)
 {
-	glm::vec3 result = glm::vec3(0);
-	float c = 1;
-	for (int i = 0; i < controlPointsCount; i++)
+	// Rivers stacked across the initial view, each one with its own meander
+	float length = aspectRatio.x - 2.0f;
+	float spacing = (aspectRatio.y - 2.0f) / riversCount;
+	float amplitude = 4.0f * spacing;
+
+	networkRivers.clear();
+	for (int river = 0; river < riversCount; river++)
 	{
-		if (i > 0)
-			c *= (controlPointsCount - i) / float(i);
-		result += c * pow((1 - t), controlPointsCount - 1 - i) * pow(t, i) * controlPoints[i];
+		std::vector<glm::vec3> controlPoints(pointsCount);
+		float y0 = -aspectRatio.y / 2.0f + 1.0f + river * spacing;
+		float phase = Utils::RandFloat(0.0f, 2.0f * float(M_PI));
+		for (int i = 0; i < pointsCount; i++)
+		{
+			float x = -length / 2.0f + length * i / (pointsCount - 1);
+			float y = y0 + amplitude * sin(i * 0.5f + phase);
+			controlPoints[i] = glm::vec3(x, y, 0.0f);
+		}
+
+		networkRivers.push_back(std::unique_ptr<Spline>(new Spline()));
+		networkRivers.back()->SetType(SPLINE_CATMULL_ROM);
+		networkRivers.back()->SetControlPoints(controlPoints);
 	}
-	return result;
+
+	riverNetwork.SetRivers(GetRiverNetwork());
+	riverNetworkValid = false;
+
+	std::vector<Spline*> rivers;
+	for (auto &spline : networkRivers)
+		rivers.push_back(spline.get());
+	riverNetworkBuffer.SetRivers(rivers);
 }
 
 void RiverEditor::OnInputUpdate(float deltaTime, int mods)
 {
-	// THICCness
+	// THICCness, the particles follow when the key is released
+	float widthChange = 0.0f;
 	if (window->KeyHold(GLFW_KEY_T))
 	{
-		riverWidth += smoothness * deltaTime;
-		UpdateVFX();
+		widthChange += smoothness * deltaTime;
 	}
 	if (window->KeyHold(GLFW_KEY_R))
 	{
-		riverWidth -= smoothness * deltaTime;
-		UpdateVFX();
+		widthChange -= smoothness * deltaTime;
+	}
+
+	if (widthChange != 0.0f)
+	{
+		// With Ctrl only the width profile around the control point under the mouse changes
+		if (mods & GLFW_MOD_CONTROL)
+		{
+			glm::ivec2 cursor = window->GetCursorPosition();
+			Spline &spline = river->GetSpline();
+			int point = spline.FindControlPoint(ScreenToWorldSpace(cursor.x, cursor.y), clickDistanceThreshold);
+			if (point != -1)
+			{
+				float width = spline.GetControlWidth(point) + widthChange / riverWidth;
+				spline.SetControlWidth(point, glm::clamp(width, widthFactorLimits.x, widthFactorLimits.y));
+			}
+		}
+		else
+		{
+			riverWidth += widthChange;
+		}
 	}
 
 	// Tiling Factor
@@ -495,12 +960,129 @@ void RiverEditor::OnKeyPress(int key, int mods)
 		UpdateVFX();
 	}
 
+	// Spline type
+	if (key == GLFW_KEY_C)
+	{
+		Spline &spline = river->GetSpline();
+		spline.SetType(static_cast<SplineType>((spline.GetType() + 1) % SPLINE_TYPES_COUNT));
+		std::cout << "Spline type: " << Spline::GetTypeName(spline.GetType()) << std::endl;
+	}
+
+	// Stress test with thousands of control points
+	if (key == GLFW_KEY_L)
+	{
+		GenerateLongRiver(longRiverPointsCount);
+	}
+
+	// Tessellation mode
+	if (key == GLFW_KEY_A)
+	{
+		tessellationMode = tessellationMode == TESSELLATION_ADAPTIVE ? TESSELLATION_UNIFORM : TESSELLATION_ADAPTIVE;
+	}
+
+	// River render path
+	if (key == GLFW_KEY_G)
+	{
+		// Skip the paths the GPU can't run
+		do
+		{
+			riverRenderPath = static_cast<RiverRenderPath>((riverRenderPath + 1) % RIVER_PATHS_COUNT);
+		} while (riverRenderPath != RIVER_PATH_CACHED_MESH && !IsRenderPathSupported(riverRenderPath));
+		std::cout << "River render path: " << GetRenderPathName(riverRenderPath) << std::endl;
+	}
+
+	// Points on each segment, only the compute path goes above 128
+	if (key == GLFW_KEY_PAGE_UP || key == GLFW_KEY_PAGE_DOWN)
+	{
+		generatedPoints = key == GLFW_KEY_PAGE_UP ? generatedPoints * 2 : generatedPoints / 2;
+		generatedPoints = glm::clamp(generatedPoints, generatedPointsLimits.x, generatedPointsLimits.y);
+		std::cout << "Points per segment: " << generatedPoints << std::endl;
+	}
+
+	// Hundreds of rivers tessellated on all cores
+	if (key == GLFW_KEY_N)
+	{
+		if (networkRivers.empty())
+			GenerateRiverNetwork(riverNetworkSize.x, riverNetworkSize.y);
+		riverNetworkOn = !riverNetworkOn;
+	}
+
+	// OpenGL state changes of the last frame
+	if (key == GLFW_KEY_F)
+	{
+		const RenderState::Statistics &statistics = RenderState::GetFrameStatistics();
+		std::cout << "State changes: " << statistics.submitted << " submitted, " << statistics.elided << " elided" << std::endl;
+
+		const RenderQueue::Statistics &queue = renderQueue.GetStatistics();
+		std::cout << "Render queue: " << queue.packets << " packets, " << queue.drawCalls << " draw calls, "
+				  << queue.indirectCommands << " indirect commands" << std::endl;
+
+		if (dynamicResolution.IsEnabled())
+		{
+			glm::ivec2 resolution = dynamicResolution.GetResolution(window->GetResolution());
+			std::cout << "Dynamic resolution: scale " << dynamicResolution.GetScale() << " (" << resolution.x << " x "
+					  << resolution.y << "), GPU frame " << dynamicResolution.GetFrameTime() << " of "
+					  << dynamicResolution.GetBudget() << " ms" << std::endl;
+		}
+
+		const PostProcessGraph::Statistics &postProcess = postProcessGraph.GetStatistics();
+		std::cout << "Post processing: " << postProcess.stages << " stages in " << postProcess.passes
+				  << " full screen passes, " << postProcess.pooledTargets << " pooled targets" << std::endl;
+
+		GPUProfiler::Print();
+	}
+
+	// Curve evaluation benchmark
+	if (key == GLFW_KEY_B)
+	{
+		if (river->GetSpline().GetSegmentCount() > 0)
+			Benchmark::BezierEvaluation(river->GetSpline().GetSegment(0), 1 << 20);
+
+		for (unsigned int pointsCount : { 1000, 10000, 100000 })
+			Benchmark::ControlPointPicking(pointsCount, 10000);
+
+		Benchmark::NearestPointOnRiver(river->GetSpline(), 1000);
+
+		if (networkRivers.empty())
+			GenerateRiverNetwork(riverNetworkSize.x, riverNetworkSize.y);
+		Benchmark::BatchTessellation(GetRiverNetwork(), generatedPoints);
+	}
+
 	// Post Processing
+	// GPU profiler
+	if (key == GLFW_KEY_Q)
+	{
+		GPUProfiler::SetEnabled(!GPUProfiler::IsEnabled());
+		std::cout << "GPU profiler: " << (GPUProfiler::IsEnabled() ? "on" : "off") << std::endl;
+	}
+
+	// Dynamic resolution
+	if (key == GLFW_KEY_D)
+	{
+		dynamicResolution.SetEnabled(!dynamicResolution.IsEnabled());
+		std::cout << "Dynamic resolution: " << (dynamicResolution.IsEnabled() ? "on" : "off") << std::endl;
+	}
+
+	// Blur kernel
+	if (key == GLFW_KEY_K)
+	{
+		blurKernel = static_cast<BlurKernel>((blurKernel + 1) % BLUR_KERNELS_COUNT);
+		std::cout << "Blur kernel: " << ComputeBlur::GetKernelName(blurKernel) << ", radius " << blurRadius << std::endl;
+	}
+
+	// Blur radius
+	if (key == GLFW_KEY_UP || key == GLFW_KEY_DOWN)
+	{
+		blurRadius = key == GLFW_KEY_UP ? blurRadius * 2 : blurRadius / 2;
+		blurRadius = glm::clamp(blurRadius, 1, static_cast<int>(ComputeBlur::MAX_RADIUS));
+		std::cout << "Blur kernel: " << ComputeBlur::GetKernelName(blurKernel) << ", radius " << blurRadius << std::endl;
+	}
+
 	if (key == GLFW_KEY_SPACE)
 	{
 		if (postProcessOn)
 		{
-			if (postProcessFX.size() - 1 == currentEffect)
+			if (postProcessChains.size() - 1 == currentEffect)
 			{
 				postProcessOn = !postProcessOn;
 				currentEffect = 0;
@@ -514,17 +1096,47 @@ void RiverEditor::OnKeyPress(int key, int mods)
 		{
 			postProcessOn = !postProcessOn;
 		}
+
+		postProcessGraph.SetEffects(postProcessChains[currentEffect]);
+		if (postProcessOn)
+		{
+			std::cout << "Post processing:";
+			for (PostEffect effect : postProcessGraph.GetEffects())
+				std::cout << " " << PostProcessGraph::GetEffectName(effect);
+			std::cout << std::endl;
+		}
+	}
+}
+
+void RiverEditor::OnKeyRelease(int key, int mods)
+{
+	// The splash particles are rebuilt once the width stops changing
+	if (key == GLFW_KEY_T || key == GLFW_KEY_R)
+	{
+		UpdateVFX();
 	}
 }
 
 void RiverEditor::OnMouseMove(int mouseX, int mouseY, int deltaX, int deltaY)
 {
+	glm::vec3 mousePos = ScreenToWorldSpace(mouseX, mouseY);
+
+	// Freehand stroke, only the tail segment is refitted
+	if (stroke.IsActive())
+	{
+		if (stroke.AddSample(mousePos))
+			UpdateStrokeRiver();
+	}
+
 	// If there's anything selected
 	if (selection != -1)
 	{		
 		// Move the selected point at the new position
-		controlPoints[selection] = ScreenToWorldSpace(mouseX, mouseY);
+		river->GetSpline().MoveControlPoint(selection, mousePos);
 	}
+
+	// Closest point of the river, only while the mouse is over it
+	hover = river->GetSpline().FindNearestPoint(mousePos, riverWidth / 2.0f);
 }
 
 void RiverEditor::OnMouseBtnPress(int mouseX, int mouseY, int button, int mods)
@@ -533,14 +1145,31 @@ void RiverEditor::OnMouseBtnPress(int mouseX, int mouseY, int button, int mods)
 	{
 		glm::vec3 mousePos = ScreenToWorldSpace(mouseX, mouseY);
 
-		// Select the nearest control point
-		for (int i = 0; i < controlPointsCount; i++)
+		// Shift starts drawing a new river
+		if (mods & GLFW_MOD_SHIFT)
 		{
-			if (glm::length(mousePos - controlPoints[i]) < clickDistanceThreshold)
-			{
-				selection = i;
-			}
+			// Pixels to world units at the current zoom
+			float pixelSize = glm::distance(ScreenToWorldSpace(0, 0), ScreenToWorldSpace(1, 0));
+			stroke.SetTolerance(strokeTolerance * pixelSize);
+			stroke.SetMinSampleDistance(pixelSize);
+			stroke.Begin(mousePos);
+
+			Spline &spline = river->GetSpline();
+			spline.SetType(SPLINE_BEZIER);
+			spline.SetControlPoints(stroke.GetControlPoints());
+			stroke.ClearChanged();
+			selection = -1;
+			return;
 		}
+
+		// Select the nearest control point
+		selection = river->GetSpline().FindControlPoint(mousePos, clickDistanceThreshold);
+	}
+
+	// Extend the river with a new segment
+	if (IS_BIT_SET(button, GLFW_MOUSE_BUTTON_RIGHT))
+	{
+		river->GetSpline().AddControlPoint(ScreenToWorldSpace(mouseX, mouseY));
 	}
 }
 
@@ -550,5 +1179,16 @@ void RiverEditor::OnMouseBtnRelease(int mouseX, int mouseY, int button, int mods
 	if (IS_BIT_SET(button, GLFW_MOUSE_BUTTON_LEFT))
 	{
 		selection = -1;
+		stroke.End();
 	}
 }
+
+void RiverEditor::OnMouseScroll(int mouseX, int mouseY, int offsetX, int offsetY)
+{
+	// Zoom the orthographic view, the adaptive tessellation follows the new scale
+	zoomLevel *= pow(1.1f, -offsetY);
+	zoomLevel = glm::clamp(zoomLevel, zoomLimits.x, zoomLimits.y);
+
+	camera->SetOrthographic(aspectRatio.x * zoomLevel, aspectRatio.y * zoomLevel, 0.01f, viewDistance);
+	camera->Update();
+}
@@ -3,16 +3,38 @@
 #include <unordered_map>
 #include <memory>
 
+#include "GizmoBatch.h"
 #include "Particle.h"
+#include "PostProcessGraph.h"
+#include "River.h"
+#include "RiverBatch.h"
+#include "RiverNetworkBuffer.h"
+#include "StrokeFitter.h"
+#include "WorkStealingPool.h"
 
 #include <Core/Engine.h>
 #include <Component\Camera\Camera.h>
 #include <Core\GPU\ParticleEffect.h>
+#include <Core\GPU\DynamicResolution.h>
 
 class Mesh;
 class Shader;
 class Texture2D;
 
+// Ways of building the river surface
+enum RiverRenderPath
+{
+	// Tessellated on the CPU, redrawn from a vertex buffer until something changes
+	RIVER_PATH_CACHED_MESH,
+	// Tessellated every frame in Bezier.GS.glsl
+	RIVER_PATH_GEOMETRY_SHADER,
+	// Tessellated in RiverTessellation.CS.glsl when something changes, the points count is bounded only by River::MAX_COMPUTE_VERTICES
+	RIVER_PATH_COMPUTE_SHADER,
+	// Tessellated every frame by the hardware tessellator, Bezier.TCS.glsl and Bezier.TES.glsl
+	RIVER_PATH_TESSELLATION_SHADER,
+	RIVER_PATHS_COUNT
+};
+
 class RiverEditor : public World
 {
 public:
@@ -29,9 +51,11 @@ private:
 	// Input controls
 	void OnInputUpdate(float deltaTime, int mods);
 	void OnKeyPress(int key, int mods) override;
+	void OnKeyRelease(int key, int mods) override;
 	void OnMouseMove(int mouseX, int mouseY, int deltaX, int deltaY) override;
 	void OnMouseBtnPress(int mouseX, int mouseY, int button, int mods) override;
 	void OnMouseBtnRelease(int mouseX, int mouseY, int button, int mods) override;
+	void OnMouseScroll(int mouseX, int mouseY, int offsetX, int offsetY) override;
 
 	void ClearScreen();
 
@@ -41,22 +65,57 @@ private:
 	// Converts the screen space position to a point on the XoY plane
 	glm::vec3 ScreenToWorldSpace(int x, int y);
 
-	// Returns a point on the bezier curve described by the control points
-	glm::vec3 GetBezierPoint(float t);
+	// Copies the segments the stroke fitter changed into the river spline
+	void UpdateStrokeRiver();
+
+	// Replaces the river with a long meandering one, used for stress testing
+	void GenerateLongRiver(int pointsCount);
+
+	// Many independent rivers drawn as a single batch
+	void GenerateRiverNetwork(int riversCount, int pointsCount);
+	void RenderRiverNetwork(Texture2D *texture);
+
+	// Control points of the river in one instanced draw
+	void RenderGizmos(Texture2D *texture);
+
+	// Whole network in one instanced draw, tessellated by the geometry shader
+	void RenderRiverNetworkInstanced(Texture2D *texture);
+	std::vector<const Spline*> GetRiverNetwork() const;
 
 	// Updates the particle effect based on the river parameters
 	void UpdateVFX();
 
-	void ApplyPostProcessing(std::shared_ptr<Shader> &shader);
+	void ApplyPostProcessing();
+
+	// The scene frame buffer and the post processing targets
+	void ResizeFrameBuffer(const glm::ivec2 &resolution);
+
+	// Compute shaders with image stores, and the blur shaders were linked
+	bool IsComputeBlurSupported();
 
-	// Basic rendering of objects
+	// Basic rendering of objects, uses the scene camera if no other camera is given
 	void RenderMesh(std::shared_ptr<Mesh> &mesh, std::shared_ptr<Shader> &shader, Texture2D *texture,
-					const glm::vec3 &position, const glm::vec3 &scale);
+					const glm::vec3 &position, const glm::vec3 &scale, EngineComponents::Camera *viewCamera = nullptr);
 
 	// Specific rendering of the curve
 	void RenderRiver(Texture2D *texture);
 
-	// Render water VFX
+	// Uniforms shared by the shaders that tessellate the segment points on the GPU
+	void SendRiverParameters(std::shared_ptr<Shader> &shader, int instancesCount);
+	void RenderRiverMesh(Texture2D *texture);
+	void RenderRiverCompute(Texture2D *texture);
+	static const char* GetRenderPathName(RiverRenderPath path);
+
+	// The context supports the path and its shaders were linked
+	bool IsRenderPathSupported(RiverRenderPath path);
+
+	// Best supported path, chosen once at startup
+	RiverRenderPath SelectRenderPath();
+
+	// Inputs of the cached river tessellation for the current frame
+	RiverMeshSettings GetRiverMeshSettings() const;
+
+	// Render water VFX, the caller sets the additive blending once for all the emitters
 	void RenderVFX(std::unique_ptr< ParticleEffect<Particle> > &effect, std::shared_ptr<Shader> &shader,
 					const glm::vec3 &position, float deltaTime);
 
@@ -69,13 +128,43 @@ private:
 	// Post processing
 	bool postProcessOn;
 	std::unique_ptr<FrameBuffer> frameBuffer;
-	std::vector<std::string> postProcessFX;
+	PostProcessGraph postProcessGraph;
+	std::vector< std::vector<PostEffect> > postProcessChains;
 	int currentEffect;
 	float waveEffectFrequency;
 
-	// Control points
-	int controlPointsCount;
-	std::vector< glm::vec3 > controlPoints;
+	// Bloom chain, also behind the blur without compute shaders
+	float bloomThreshold;
+	float bloomIntensity;
+	int bloomLevels;
+	int blurLevels;
+
+	// Compute blur, the radius is in texels
+	BlurKernel blurKernel;
+	int blurRadius;
+
+	// Scale of the scene frame buffer, chosen for the GPU time of a frame to fit the budget
+	DynamicResolution dynamicResolution;
+	float frameBudget;
+	glm::vec2 resolutionScaleLimits;
+
+	// River curve
+	std::unique_ptr<River> river;
+	int longRiverPointsCount;
+
+	// River network, tessellated on the CPU workers, or on the GPU from a shared storage buffer
+	std::vector< std::unique_ptr<Spline> > networkRivers;
+	std::unique_ptr<WorkStealingPool> tessellationPool;
+	RiverBatch riverNetwork;
+	RiverNetworkBuffer riverNetworkBuffer;
+	RiverMeshSettings riverNetworkSettings;
+	bool riverNetworkValid;
+	bool riverNetworkOn;
+	glm::ivec2 riverNetworkSize;
+
+	// Levels of detail of the network, the first simplified one deviates by a fraction of the river width
+	int riverNetworkLevels;
+	float riverNetworkBaseTolerance;
 
 	// River animation
 	float animationSpeed;
@@ -84,6 +173,8 @@ private:
 	// Particle Effect
 	std::unique_ptr< ParticleEffect<Particle> > splashEffect;
 	glm::vec3 particleFallSpeed;
+	std::vector<float> emitterParameters;
+	std::vector<glm::vec3> emitterPositions;
 
 	// Editing
 	float smoothness;
@@ -91,6 +182,8 @@ private:
 
 	// Camera
 	float viewDistance;
+	float zoomLevel;
+	glm::vec2 zoomLimits;
 	glm::vec2 aspectRatio;
 	std::unique_ptr<EngineComponents::Camera> camera;
 
@@ -98,8 +191,34 @@ private:
 	int selection;
 	float clickDistanceThreshold;
 
+	// Point of the river under the mouse
+	NearestPoint hover;
+
+	// Control point gizmos, only the moved ones are uploaded
+	GizmoBatch gizmos;
+
+	// Scene meshes, sorted and drawn with indirect calls before the VFX
+	RenderQueue renderQueue;
+
+	// Freehand drawing of a new river, the tolerance is measured in pixels
+	StrokeFitter stroke;
+	float strokeTolerance;
+
 	// Curve generatiom parameters
 	int instanceCount;
 	int generatedPoints;
+	glm::ivec2 generatedPointsLimits;
 	float riverWidth;
+
+	// Bounds of the width profile, relative to riverWidth
+	glm::vec2 widthFactorLimits;
+
+	// Adaptive tessellation, the tolerance is measured in pixels
+	TessellationMode tessellationMode;
+	float flatnessTolerance;
+
+	// Hardware tessellation, target length of the tessellated edges in pixels
+	float tessellationEdgeLength;
+
+	RiverRenderPath riverRenderPath;
 };
\ No newline at end of file
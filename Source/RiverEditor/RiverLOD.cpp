@@ -0,0 +1,218 @@
+#include "RiverLOD.h"
+
+#include <algorithm>
+#include <utility>
+#include <limits>
+
+namespace Simplification
+{
+	void DouglasPeucker(const glm::vec3 *points, int count, float tolerance, std::vector<int> &kept)
+	{
+		kept.clear();
+		if (count <= 2)
+		{
+			for (int i = 0; i < count; i++)
+				kept.push_back(i);
+			return;
+		}
+
+		std::vector<bool> keep(count, false);
+		keep[0] = keep[count - 1] = true;
+
+		// Explicit stack, long rivers would overflow a recursive version
+		std::vector<std::pair<int, int>> ranges;
+		ranges.push_back(std::make_pair(0, count - 1));
+		float toleranceSquared = tolerance * tolerance;
+
+		while (!ranges.empty())
+		{
+			int first = ranges.back().first;
+			int last = ranges.back().second;
+			ranges.pop_back();
+
+			// Farthest point from the chord, distances are measured in the XoY plane
+			glm::vec2 a = glm::vec2(points[first]);
+			glm::vec2 chord = glm::vec2(points[last]) - a;
+			float chordLength = glm::dot(chord, chord);
+
+			int farthest = -1;
+			float farthestDistance = toleranceSquared;
+			for (int i = first + 1; i < last; i++)
+			{
+				glm::vec2 delta = glm::vec2(points[i]) - a;
+				float t = chordLength > 0.0f ? glm::clamp(glm::dot(delta, chord) / chordLength, 0.0f, 1.0f) : 0.0f;
+				glm::vec2 offset = delta - t * chord;
+				float distance = glm::dot(offset, offset);
+				if (distance > farthestDistance)
+				{
+					farthestDistance = distance;
+					farthest = i;
+				}
+			}
+
+			if (farthest == -1)
+				continue;
+
+			keep[farthest] = true;
+			ranges.push_back(std::make_pair(first, farthest));
+			ranges.push_back(std::make_pair(farthest, last));
+		}
+
+		for (int i = 0; i < count; i++)
+		{
+			if (keep[i])
+				kept.push_back(i);
+		}
+	}
+}
+
+RiverLOD::RiverLOD()
+{
+	boundsMin = boundsMax = glm::vec3(0);
+	width = 0.0f;
+}
+
+void RiverLOD::Build(const Spline &spline, const RiverMeshSettings &settings, int levelsCount, float baseTolerance)
+{
+	levels.clear();
+	int segmentCount = spline.GetSegmentCount();
+	if (segmentCount == 0)
+		return;
+
+	// Centerline of the whole river, the shared end points of the segments are sampled once
+	int pointsCount = glm::clamp(settings.pointsCount, 2, static_cast<int>(SegmentTessellator::MAX_POINTS));
+	int totalCount = segmentCount * (pointsCount - 1) + 1;
+	points.resize(totalCount);
+	normals.resize(totalCount);
+	widths.resize(totalCount);
+	texCoords.resize(totalCount);
+
+	std::vector<float> parameters(pointsCount);
+	for (int i = 0; i < pointsCount; i++)
+		parameters[i] = i / float(pointsCount - 1);
+
+	for (int segment = 0; segment < segmentCount; segment++)
+	{
+		int first = segment * (pointsCount - 1);
+		spline.GetSegment(segment).Evaluate(parameters.data(), pointsCount, &points[first], nullptr, &normals[first]);
+		spline.EvaluateWidth(segment, parameters.data(), pointsCount, &widths[first]);
+		for (int i = 0; i < pointsCount; i++)
+			texCoords[first + i] = (segment + spline.GetSegmentLengthFraction(segment, parameters[i])) * settings.tilingFactor;
+	}
+	width = settings.width;
+
+	// Every level keeps a subset of the points of the full resolution one
+	std::vector<int> kept;
+	levels.reserve(std::max(levelsCount, 1));
+	for (int level = 0; level < MAX_LEVELS; level++)
+	{
+		// The coarsest level bounds the vertices drawn when zoomed out
+		if (level > 0 && level >= levelsCount && static_cast<int>(kept.size()) <= MIN_LEVEL_POINTS)
+			break;
+
+		levels.emplace_back();
+		if (level == 0)
+		{
+			kept.resize(totalCount);
+			for (int i = 0; i < totalCount; i++)
+				kept[i] = i;
+			levels[level].tolerance = 0.0f;
+		}
+		else
+		{
+			levels[level].tolerance = level == 1 ? baseTolerance : 2.0f * levels[level - 1].tolerance;
+			Simplification::DouglasPeucker(points.data(), totalCount, levels[level].tolerance, kept);
+		}
+		BuildLevel(levels[level], kept);
+	}
+
+	// The banks of the full resolution level bound every other level
+	const std::vector<RiverVertex> &vertices = levels[0].vertices;
+	boundsMin = boundsMax = vertices[0].position;
+	for (auto &vertex : vertices)
+	{
+		boundsMin = glm::min(boundsMin, vertex.position);
+		boundsMax = glm::max(boundsMax, vertex.position);
+	}
+
+	// Only the strips are needed after this
+	points = std::vector<glm::vec3>();
+	normals = std::vector<glm::vec3>();
+	widths = std::vector<float>();
+	texCoords = std::vector<float>();
+}
+
+int RiverLOD::GetLevelsCount() const
+{
+	return static_cast<int>(levels.size());
+}
+
+float RiverLOD::GetTolerance(int level) const
+{
+	return levels[level].tolerance;
+}
+
+const std::vector<RiverVertex>& RiverLOD::GetVertices(int level) const
+{
+	return levels[level].vertices;
+}
+
+int RiverLOD::SelectLevel(const glm::mat4 &worldToScreen, const glm::vec2 &screenSize, float tolerancePixels) const
+{
+	if (levels.empty())
+		return -1;
+
+	// Screen bounds of the river, an affine transform only needs the corners
+	glm::vec2 screenMin(std::numeric_limits<float>::max());
+	glm::vec2 screenMax(-std::numeric_limits<float>::max());
+	for (int corner = 0; corner < 4; corner++)
+	{
+		glm::vec3 point(corner & 1 ? boundsMax.x : boundsMin.x, corner & 2 ? boundsMax.y : boundsMin.y, boundsMin.z);
+		glm::vec2 screen = glm::vec2(worldToScreen * glm::vec4(point, 1.0f));
+		screenMin = glm::min(screenMin, screen);
+		screenMax = glm::max(screenMax, screen);
+	}
+
+	if (screenMax.x < 0.0f || screenMax.y < 0.0f || screenMin.x > screenSize.x || screenMin.y > screenSize.y)
+		return -1;
+
+	// Pixels covered by a world unit
+	float scale = glm::length(glm::vec2(worldToScreen[0]));
+
+	int selected = 0;
+	for (int level = 1; level < GetLevelsCount(); level++)
+	{
+		if (levels[level].tolerance * scale > tolerancePixels)
+			break;
+		selected = level;
+	}
+	return selected;
+}
+
+void RiverLOD::BuildLevel(Level &level, const std::vector<int> &kept)
+{
+	int count = static_cast<int>(kept.size());
+	levelPoints.resize(count);
+	levelNormals.resize(count);
+	levelWidths.resize(count);
+	for (int i = 0; i < count; i++)
+	{
+		levelPoints[i] = points[kept[i]];
+		levelNormals[i] = normals[kept[i]];
+		levelWidths[i] = widths[kept[i]];
+	}
+
+	// Simplified centerlines bend harder, so their banks are trimmed as well
+	leftBank.Build(levelPoints.data(), levelNormals.data(), count, -width / 2.0f, levelWidths.data());
+	rightBank.Build(levelPoints.data(), levelNormals.data(), count, width / 2.0f, levelWidths.data());
+
+	level.vertices.resize(2 * count);
+	for (int i = 0; i < count; i++)
+	{
+		float u = texCoords[kept[i]];
+		level.vertices[2 * i].position = leftBank.GetPositions()[i];
+		level.vertices[2 * i].texCoord = glm::vec2(u, 0.0f);
+		level.vertices[2 * i + 1].position = rightBank.GetPositions()[i];
+		level.vertices[2 * i + 1].texCoord = glm::vec2(u, 1.0f);
+	}
+}
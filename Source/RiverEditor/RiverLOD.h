@@ -0,0 +1,71 @@
+#pragma once
+
+#include <vector>
+
+#include <include/glm.h>
+
+#include "SegmentTessellator.h"
+
+namespace Simplification
+{
+	// Douglas-Peucker, indices of the points kept so that the polyline stays within tolerance
+	// The first and last points are always kept, indices are sorted
+	void DouglasPeucker(const glm::vec3 *points, int count, float tolerance, std::vector<int> &kept);
+}
+
+// Levels of detail of a river surface, built once from the full resolution centerline.
+// Level 0 is the full tessellation, every next level simplifies the centerline with
+// twice the tolerance of the previous one and rebuilds the banks from the kept points.
+// Levels are added past the requested count until the centerline is down to a few points,
+// so a river seen from far away is drawn with a handful of vertices whatever its length.
+// Each level is a single triangle strip for the whole river.
+class RiverLOD
+{
+public:
+	RiverLOD();
+
+	// Uniform tessellation with settings.pointsCount on each segment, tolerances are in world units
+	// levelsCount is the minimum, the actual count is returned by GetLevelsCount
+	void Build(const Spline &spline, const RiverMeshSettings &settings, int levelsCount, float baseTolerance);
+
+	int GetLevelsCount() const;
+	float GetTolerance(int level) const;
+	const std::vector<RiverVertex>& GetVertices(int level) const;
+
+	// Coarsest level whose error stays under tolerancePixels on screen, -1 if the river is not visible
+	int SelectLevel(const glm::mat4 &worldToScreen, const glm::vec2 &screenSize, float tolerancePixels) const;
+
+	// Coarsest centerline that stops adding levels, and the cap for tolerances that never get there
+	static const int MIN_LEVEL_POINTS = 4;
+	static const int MAX_LEVELS = 24;
+
+private:
+	struct Level
+	{
+		float tolerance;
+		std::vector<RiverVertex> vertices;
+	};
+
+	void BuildLevel(Level &level, const std::vector<int> &kept);
+
+private:
+	std::vector<Level> levels;
+
+	// Bounds of the surface, used to skip the rivers outside the screen
+	glm::vec3 boundsMin;
+	glm::vec3 boundsMax;
+
+	// Full resolution centerline, kept only while building
+	std::vector<glm::vec3> points;
+	std::vector<glm::vec3> normals;
+	std::vector<float> widths;
+	std::vector<float> texCoords;
+	float width;
+
+	// Scratch memory
+	std::vector<glm::vec3> levelPoints;
+	std::vector<glm::vec3> levelNormals;
+	std::vector<float> levelWidths;
+	RiverBanks leftBank;
+	RiverBanks rightBank;
+};
@@ -0,0 +1,143 @@
+#include "RiverNetworkBuffer.h"
+
+#include <algorithm>
+
+#include <include/utils.h>
+#include <Core/GPU/RenderState.h>
+
+RiverNetworkBuffer::RiverNetworkBuffer()
+{
+	maxSegments = 0;
+	VAO = 0;
+	segmentBuffer = 0;
+	arcLengthBuffer = 0;
+	rangeBuffer = 0;
+}
+
+RiverNetworkBuffer::~RiverNetworkBuffer()
+{
+	if (VAO)
+	{
+		RenderState::DeleteBuffers(1, &segmentBuffer);
+		RenderState::DeleteBuffers(1, &arcLengthBuffer);
+		RenderState::DeleteBuffers(1, &rangeBuffer);
+		RenderState::DeleteVertexArrays(1, &VAO);
+	}
+}
+
+void RiverNetworkBuffer::SetRivers(const std::vector<Spline*> &rivers)
+{
+	this->rivers = rivers;
+	Pack();
+}
+
+int RiverNetworkBuffer::GetRiversCount() const
+{
+	return static_cast<int>(rivers.size());
+}
+
+void RiverNetworkBuffer::UploadRivers()
+{
+	// A river with a different number of segments doesn't fit its slice anymore
+	for (size_t i = 0; i < rivers.size(); i++)
+	{
+		if (rivers[i]->GetSegmentCount() != ranges[i].segmentsCount)
+		{
+			Pack();
+			return;
+		}
+	}
+
+	bool uploaded = false;
+	for (size_t i = 0; i < rivers.size(); i++)
+	{
+		Spline &spline = *rivers[i];
+		if (!spline.IsDirty())
+			continue;
+
+		int first = spline.GetFirstDirtySegment();
+		int count = std::min(spline.GetDirtySegmentsCount(), spline.GetSegmentCount() - first);
+		if (count > 0)
+		{
+			GLintptr offset = 4 * (ranges[i].firstSegment + first) * sizeof(glm::vec4);
+			GLsizeiptr size = 4 * count * sizeof(glm::vec4);
+
+			glBindBuffer(GL_ARRAY_BUFFER, segmentBuffer);
+			glBufferSubData(GL_ARRAY_BUFFER, offset, size, &spline.GetSegmentPoints()[4 * first]);
+			glBindBuffer(GL_ARRAY_BUFFER, arcLengthBuffer);
+			glBufferSubData(GL_ARRAY_BUFFER, offset, size, &spline.GetArcLengthTable()[4 * first]);
+			uploaded = true;
+		}
+		spline.ClearDirty();
+	}
+
+	if (uploaded)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		CheckOpenGLError();
+	}
+}
+
+void RiverNetworkBuffer::Draw() const
+{
+	if (!VAO || maxSegments == 0)
+		return;
+
+	RenderState::BindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, segmentBuffer);
+	RenderState::BindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, arcLengthBuffer);
+	RenderState::BindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, rangeBuffer);
+
+	RenderState::BindVertexArray(VAO);
+	glDrawArraysInstanced(GL_LINES_ADJACENCY, 0, 4 * maxSegments, static_cast<GLsizei>(rivers.size()));
+}
+
+void RiverNetworkBuffer::Pack()
+{
+	// The slices follow each other in the order of the rivers
+	ranges.resize(rivers.size());
+	maxSegments = 0;
+	int segmentsCount = 0;
+	for (size_t i = 0; i < rivers.size(); i++)
+	{
+		ranges[i].firstSegment = segmentsCount;
+		ranges[i].segmentsCount = rivers[i]->GetSegmentCount();
+		ranges[i].padding[0] = ranges[i].padding[1] = 0;
+		segmentsCount += ranges[i].segmentsCount;
+		maxSegments = std::max(maxSegments, ranges[i].segmentsCount);
+	}
+
+	if (!VAO)
+	{
+		glGenVertexArrays(1, &VAO);
+		glGenBuffers(1, &segmentBuffer);
+		glGenBuffers(1, &arcLengthBuffer);
+		glGenBuffers(1, &rangeBuffer);
+	}
+
+	// Allocate the whole network, then copy every river into its slice
+	GLsizeiptr size = 4 * std::max(segmentsCount, 1) * sizeof(glm::vec4);
+	glBindBuffer(GL_ARRAY_BUFFER, segmentBuffer);
+	glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+	for (size_t i = 0; i < rivers.size(); i++)
+	{
+		const std::vector<glm::vec4> &points = rivers[i]->GetSegmentPoints();
+		if (!points.empty())
+			glBufferSubData(GL_ARRAY_BUFFER, 4 * ranges[i].firstSegment * sizeof(glm::vec4), points.size() * sizeof(glm::vec4), points.data());
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, arcLengthBuffer);
+	glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+	for (size_t i = 0; i < rivers.size(); i++)
+	{
+		const std::vector<glm::vec4> &arcLengths = rivers[i]->GetArcLengthTable();
+		if (!arcLengths.empty())
+			glBufferSubData(GL_ARRAY_BUFFER, 4 * ranges[i].firstSegment * sizeof(glm::vec4), arcLengths.size() * sizeof(glm::vec4), arcLengths.data());
+		rivers[i]->ClearDirty();
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, rangeBuffer);
+	glBufferData(GL_ARRAY_BUFFER, std::max<size_t>(ranges.size(), 1) * sizeof(RiverRange), ranges.empty() ? nullptr : ranges.data(), GL_DYNAMIC_DRAW);
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	CheckOpenGLError();
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vector>
+
+#include <include/gl.h>
+
+#include "Spline.h"
+
+// Segment points of many rivers packed in shared storage buffers, drawn with a single
+// instanced call, one instance for each river.
+// RiverNetwork.VS.glsl pulls the points of segment gl_VertexID / 4 of river gl_InstanceID,
+// the slots past the end of a shorter river are dropped by the geometry shader.
+// Each river owns a slice of the buffers, so editing one only uploads its dirty segments.
+class RiverNetworkBuffer
+{
+public:
+	RiverNetworkBuffer();
+	~RiverNetworkBuffer();
+
+	// The splines must stay alive while the buffer uses them, their dirty ranges are cleared on upload
+	void SetRivers(const std::vector<Spline*> &rivers);
+	int GetRiversCount() const;
+
+	// Sends the segments modified since the last upload, the slices are packed again if a river grew
+	void UploadRivers();
+
+	// Binds the segments to binding 1, the arc lengths to 3 and the river ranges to 4
+	void Draw() const;
+
+private:
+	// First segment and segments count of a river, ivec4 in std430
+	struct RiverRange
+	{
+		GLint firstSegment;
+		GLint segmentsCount;
+		GLint padding[2];
+	};
+
+	// Allocates the buffers and uploads every river
+	void Pack();
+
+private:
+	std::vector<Spline*> rivers;
+	std::vector<RiverRange> ranges;
+
+	// Segments of the longest river, the vertices drawn for each instance
+	int maxSegments;
+
+	// No vertex attributes, everything is read from the storage buffers
+	GLuint VAO;
+	GLuint segmentBuffer;
+	GLuint arcLengthBuffer;
+	GLuint rangeBuffer;
+};
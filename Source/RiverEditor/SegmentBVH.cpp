@@ -0,0 +1,210 @@
+#include "SegmentBVH.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+	glm::vec3 CubicPoint(const glm::vec4 *p, float t)
+	{
+		float s = 1 - t;
+		return glm::vec3(s * s * s * p[0] + 3 * s * s * t * p[1] + 3 * s * t * t * p[2] + t * t * t * p[3]);
+	}
+
+	glm::vec3 CubicTangent(const glm::vec4 *p, float t)
+	{
+		float s = 1 - t;
+		return glm::vec3(3 * s * s * (p[1] - p[0]) + 6 * s * t * (p[2] - p[1]) + 3 * t * t * (p[3] - p[2]));
+	}
+
+	glm::vec3 CubicSecondDerivative(const glm::vec4 *p, float t)
+	{
+		return glm::vec3(6 * (1 - t) * (p[2] - 2.0f * p[1] + p[0]) + 6 * t * (p[3] - 2.0f * p[2] + p[1]));
+	}
+}
+
+SegmentBVH::SegmentBVH()
+{
+	segmentCount = 0;
+	firstLeaf = 0;
+}
+
+void SegmentBVH::Build(const std::vector<glm::vec4> &segmentPoints)
+{
+	segmentCount = static_cast<int>(segmentPoints.size() / 4);
+
+	int leaves = 1;
+	while (leaves < segmentCount)
+		leaves *= 2;
+
+	// Padding leaves get an empty box, so they are never visited
+	firstLeaf = leaves - 1;
+	Box empty;
+	empty.min = glm::vec3(std::numeric_limits<float>::max());
+	empty.max = glm::vec3(-std::numeric_limits<float>::max());
+	nodes.assign(2 * leaves - 1, empty);
+
+	Refit(segmentPoints, 0, segmentCount);
+}
+
+void SegmentBVH::Refit(const std::vector<glm::vec4> &segmentPoints, int first, int last)
+{
+	if (segmentCount * 4 != static_cast<int>(segmentPoints.size()))
+	{
+		Build(segmentPoints);
+		return;
+	}
+
+	last = std::min(last, segmentCount);
+	if (last <= first)
+		return;
+
+	for (int i = first; i < last; i++)
+	{
+		UpdateLeaf(segmentPoints, i);
+	}
+
+	// Walk up one level at a time, the changed nodes stay a contiguous range
+	int begin = firstLeaf + first;
+	int end = firstLeaf + last - 1;
+	while (begin > 0)
+	{
+		begin = (begin - 1) / 2;
+		end = (end - 1) / 2;
+		for (int node = begin; node <= end; node++)
+		{
+			UpdateNode(node);
+		}
+	}
+}
+
+int SegmentBVH::GetSegmentCount() const
+{
+	return segmentCount;
+}
+
+NearestPoint SegmentBVH::FindNearest(const std::vector<glm::vec4> &segmentPoints, const glm::vec3 &position,
+										float maxDistance) const
+{
+	NearestPoint result;
+	if (segmentCount == 0)
+		return result;
+
+	float best = maxDistance * maxDistance;
+
+	stack.clear();
+	stack.push_back(0);
+	while (!stack.empty())
+	{
+		int node = stack.back();
+		stack.pop_back();
+
+		if (DistanceSquared(nodes[node], position) >= best)
+			continue;
+
+		if (node >= firstLeaf)
+		{
+			int segment = node - firstLeaf;
+			const glm::vec4 *points = &segmentPoints[4 * segment];
+			float t = ClosestParameter(points, position);
+			glm::vec3 point = CubicPoint(points, t);
+			glm::vec3 delta = position - point;
+			float distance = glm::dot(delta, delta);
+			if (distance < best)
+			{
+				best = distance;
+				result.segment = segment;
+				result.localT = t;
+				result.position = point;
+			}
+			continue;
+		}
+
+		// Visit the closer child first, so the other one is more likely to be pruned
+		int left = 2 * node + 1;
+		int right = left + 1;
+		if (DistanceSquared(nodes[left], position) < DistanceSquared(nodes[right], position))
+			std::swap(left, right);
+		stack.push_back(left);
+		stack.push_back(right);
+	}
+
+	if (result.segment == -1)
+		return result;
+
+	result.t = (result.segment + result.localT) / segmentCount;
+	result.distance = sqrt(best);
+
+	// Same normal as the river surface, in the XoY plane
+	glm::vec3 tangent = CubicTangent(&segmentPoints[4 * result.segment], result.localT);
+	glm::vec2 normal(tangent.y, -tangent.x);
+	result.side = glm::dot(normal, glm::vec2(position - result.position)) >= 0.0f ? 1 : -1;
+
+	return result;
+}
+
+void SegmentBVH::UpdateLeaf(const std::vector<glm::vec4> &segmentPoints, int segment)
+{
+	Box &box = nodes[firstLeaf + segment];
+	box.min = box.max = glm::vec3(segmentPoints[4 * segment]);
+	for (int i = 1; i < 4; i++)
+	{
+		glm::vec3 point = glm::vec3(segmentPoints[4 * segment + i]);
+		box.min = glm::min(box.min, point);
+		box.max = glm::max(box.max, point);
+	}
+}
+
+void SegmentBVH::UpdateNode(int node)
+{
+	const Box &left = nodes[2 * node + 1];
+	const Box &right = nodes[2 * node + 2];
+	nodes[node].min = glm::min(left.min, right.min);
+	nodes[node].max = glm::max(left.max, right.max);
+}
+
+float SegmentBVH::DistanceSquared(const Box &box, const glm::vec3 &position)
+{
+	// Empty boxes are never closer than anything
+	if (box.min.x > box.max.x)
+		return std::numeric_limits<float>::max();
+
+	glm::vec3 delta = glm::max(glm::max(box.min - position, position - box.max), glm::vec3(0.0f));
+	return glm::dot(delta, delta);
+}
+
+float SegmentBVH::ClosestParameter(const glm::vec4 *points, const glm::vec3 &position)
+{
+	// Coarse sampling, a cubic has few local minima
+	const int samples = 8;
+	float bestT = 0.0f;
+	float best = std::numeric_limits<float>::max();
+	for (int i = 0; i <= samples; i++)
+	{
+		float t = i / float(samples);
+		glm::vec3 delta = CubicPoint(points, t) - position;
+		float distance = glm::dot(delta, delta);
+		if (distance < best)
+		{
+			best = distance;
+			bestT = t;
+		}
+	}
+
+	// Newton's method on the derivative of the squared distance
+	float t = bestT;
+	for (int i = 0; i < 4; i++)
+	{
+		glm::vec3 delta = CubicPoint(points, t) - position;
+		glm::vec3 tangent = CubicTangent(points, t);
+		float numerator = glm::dot(delta, tangent);
+		float denominator = glm::dot(tangent, tangent) + glm::dot(delta, CubicSecondDerivative(points, t));
+		if (denominator <= 0.0f)
+			break;
+		t = glm::clamp(t - numerator / denominator, 0.0f, 1.0f);
+	}
+
+	// Newton can overshoot on tight bends, keep the coarse sample if it was better
+	glm::vec3 delta = CubicPoint(points, t) - position;
+	return glm::dot(delta, delta) <= best ? t : bestT;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <vector>
+
+#include <include/glm.h>
+
+// Closest point of a river to a query position
+struct NearestPoint
+{
+	NearestPoint() : segment(-1), t(0.0f), localT(0.0f), distance(0.0f), side(0) {}
+
+	// -1 when nothing was found within the search radius
+	int segment;
+
+	// Global parameter of the whole spline and parameter inside the segment
+	float t;
+	float localT;
+
+	glm::vec3 position;
+	float distance;
+
+	// 1 on the side of the curve normal, -1 on the other one
+	int side;
+};
+
+// Bounding volume hierarchy over cubic Bezier segments, 4 points each.
+// The curve lies inside the convex hull of its points, so their box bounds the segment.
+// Segments follow each other along a river, so the tree splits them by index and is stored
+// implicitly as a complete binary tree. Moving points only refits the boxes above the
+// segments that changed, the topology is rebuilt only when the segment count changes.
+class SegmentBVH
+{
+public:
+	SegmentBVH();
+
+	// Rebuilds the whole tree
+	void Build(const std::vector<glm::vec4> &segmentPoints);
+
+	// Updates the boxes of the segments in [first, last) and of their ancestors
+	void Refit(const std::vector<glm::vec4> &segmentPoints, int first, int last);
+
+	int GetSegmentCount() const;
+
+	// Nearest point on the curve closer than maxDistance
+	NearestPoint FindNearest(const std::vector<glm::vec4> &segmentPoints, const glm::vec3 &position,
+								float maxDistance) const;
+
+private:
+	struct Box
+	{
+		glm::vec3 min;
+		glm::vec3 max;
+	};
+
+	void UpdateLeaf(const std::vector<glm::vec4> &segmentPoints, int segment);
+	void UpdateNode(int node);
+
+	static float DistanceSquared(const Box &box, const glm::vec3 &position);
+
+	// Closest parameter of a single segment, coarse sampling refined with Newton's method
+	static float ClosestParameter(const glm::vec4 *points, const glm::vec3 &position);
+
+private:
+	int segmentCount;
+
+	// Index of the first leaf, leaves are padded up to a power of 2
+	int firstLeaf;
+	std::vector<Box> nodes;
+
+	// Traversal stack, kept between queries
+	mutable std::vector<int> stack;
+};
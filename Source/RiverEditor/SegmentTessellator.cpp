@@ -0,0 +1,84 @@
+#include "SegmentTessellator.h"
+
+RiverMeshSettings::RiverMeshSettings()
+{
+	mode = TESSELLATION_UNIFORM;
+	pointsCount = 2;
+	worldToScreen = glm::mat4(1);
+	flatnessTolerance = 1.0f;
+	width = 1.0f;
+	tilingFactor = 1.0f;
+}
+
+bool RiverMeshSettings::operator==(const RiverMeshSettings &other) const
+{
+	if (mode != other.mode || width != other.width || tilingFactor != other.tilingFactor)
+		return false;
+
+	// The unused parameters of the other mode don't matter
+	if (mode == TESSELLATION_UNIFORM)
+		return pointsCount == other.pointsCount;
+
+	return flatnessTolerance == other.flatnessTolerance && worldToScreen == other.worldToScreen;
+}
+
+bool RiverMeshSettings::operator!=(const RiverMeshSettings &other) const
+{
+	return !(*this == other);
+}
+
+int SegmentTessellator::GetPointsCount(const BezierCurve &curve, const RiverMeshSettings &settings)
+{
+	int pointsCount = settings.pointsCount;
+	if (settings.mode == TESSELLATION_ADAPTIVE)
+	{
+		pointsCount = curve.EstimateSegmentCount(settings.flatnessTolerance, settings.worldToScreen) + 1;
+	}
+	return glm::clamp(pointsCount, 2, static_cast<int>(MAX_POINTS));
+}
+
+void SegmentTessellator::Tessellate(const Spline &spline, int segment, const RiverMeshSettings &settings, int pointsCount,
+									RiverVertex *vertices, GLuint *indices, GLuint baseVertex)
+{
+	parameters.resize(pointsCount);
+	positions.resize(pointsCount);
+	normals.resize(pointsCount);
+	widths.resize(pointsCount);
+
+	float step = 1.0f / (pointsCount - 1);
+	for (int i = 0; i < pointsCount; i++)
+		parameters[i] = i * step;
+
+	spline.GetSegment(segment).Evaluate(parameters.data(), pointsCount, positions.data(), nullptr, normals.data());
+	spline.EvaluateWidth(segment, parameters.data(), pointsCount, widths.data());
+
+	// Offset both banks, the loops of tight bends are merged into the point where the bank crosses itself
+	leftBank.Build(positions.data(), normals.data(), pointsCount, -settings.width / 2.0f, widths.data());
+	rightBank.Build(positions.data(), normals.data(), pointsCount, settings.width / 2.0f, widths.data());
+	const std::vector<int> &leftMerged = leftBank.GetMergedInto();
+	const std::vector<int> &rightMerged = rightBank.GetMergedInto();
+
+	// One point on each side of the curve, the texture follows the arc length inside the segment
+	for (int i = 0; i < pointsCount; i++)
+	{
+		float u = (segment + spline.GetSegmentLengthFraction(segment, parameters[i])) * settings.tilingFactor;
+
+		vertices->position = leftBank.GetPositions()[i];
+		vertices->texCoord = glm::vec2(u, 0.0f);
+		vertices++;
+
+		vertices->position = rightBank.GetPositions()[i];
+		vertices->texCoord = glm::vec2(u, 1.0f);
+		vertices++;
+	}
+
+	if (!indices)
+		return;
+
+	// Trimmed points reuse the vertex they were merged into, their triangles are degenerate
+	for (int i = 0; i < pointsCount; i++)
+	{
+		*indices++ = baseVertex + 2 * leftMerged[i];
+		*indices++ = baseVertex + 2 * rightMerged[i] + 1;
+	}
+}
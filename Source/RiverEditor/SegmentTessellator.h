@@ -0,0 +1,69 @@
+#pragma once
+
+#include <vector>
+
+#include <include/gl.h>
+
+#include "Spline.h"
+#include "RiverBanks.h"
+
+// How the river curve is split into segments, must match the values in Bezier.GS.glsl
+enum TessellationMode
+{
+	TESSELLATION_UNIFORM = 0,
+	TESSELLATION_ADAPTIVE = 1
+};
+
+// Inputs of the river tessellation, the cached mesh is rebuilt when any of them changes
+struct RiverMeshSettings
+{
+	RiverMeshSettings();
+
+	bool operator==(const RiverMeshSettings &other) const;
+	bool operator!=(const RiverMeshSettings &other) const;
+
+	TessellationMode mode;
+
+	// Points on each segment in uniform mode
+	int pointsCount;
+
+	// Adaptive mode, world to pixels transform and tolerance in pixels
+	glm::mat4 worldToScreen;
+	float flatnessTolerance;
+
+	float width;
+	float tilingFactor;
+};
+
+struct RiverVertex
+{
+	glm::vec3 position;
+	glm::vec2 texCoord;
+};
+
+// Builds the surface of a single segment, shared by the cached mesh and the river batches.
+// The output only depends on the spline and the settings, so segments can be tessellated
+// on several threads as long as each one has its own tessellator for the scratch memory.
+class SegmentTessellator
+{
+public:
+	// Points used for the segment, between 2 and MAX_POINTS
+	static int GetPointsCount(const BezierCurve &curve, const RiverMeshSettings &settings);
+
+	// Writes 2 * pointsCount vertices, one on each bank for every point
+	// settings.width is scaled by the width profile of the spline
+	// Indices are optional, the trimmed points of the banks reuse the vertex they were merged into
+	void Tessellate(const Spline &spline, int segment, const RiverMeshSettings &settings, int pointsCount,
+					RiverVertex *vertices, GLuint *indices = nullptr, GLuint baseVertex = 0);
+
+	// Upper bound of points per segment, same as the geometry shader
+	static const int MAX_POINTS = 128;
+
+private:
+	std::vector<float> parameters;
+	std::vector<glm::vec3> positions;
+	std::vector<glm::vec3> normals;
+	std::vector<float> widths;
+	RiverBanks leftBank;
+	RiverBanks rightBank;
+};
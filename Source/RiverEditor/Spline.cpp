@@ -0,0 +1,408 @@
+#include "Spline.h"
+
+#include <algorithm>
+
+Spline::Spline()
+{
+	type = SPLINE_BEZIER;
+	segmentOffsetsValid = false;
+}
+
+void Spline::SetType(SplineType type)
+{
+	this->type = type;
+	Rebuild();
+}
+
+SplineType Spline::GetType() const
+{
+	return type;
+}
+
+const char* Spline::GetTypeName(SplineType type)
+{
+	switch (type)
+	{
+	case SPLINE_BEZIER:
+		return "Bezier";
+	case SPLINE_CATMULL_ROM:
+		return "Catmull-Rom";
+	case SPLINE_BSPLINE:
+		return "B-spline";
+	default:
+		return "Unknown";
+	}
+}
+
+void Spline::SetControlPoints(const std::vector<glm::vec3> &controlPoints)
+{
+	this->controlPoints = controlPoints;
+	controlWidths.assign(controlPoints.size(), 1.0f);
+	controlPointGrid.Build(controlPoints);
+	Rebuild();
+}
+
+const std::vector<glm::vec3>& Spline::GetControlPoints() const
+{
+	return controlPoints;
+}
+
+int Spline::GetControlPointsCount() const
+{
+	return static_cast<int>(controlPoints.size());
+}
+
+void Spline::MoveControlPoint(int index, const glm::vec3 &position)
+{
+	controlPoints[index] = position;
+	controlPointGrid.Move(index, position);
+
+	int first, last;
+	GetSegmentsOfPoint(index, first, last);
+	for (int i = first; i <= last; i++)
+	{
+		RebuildSegment(i);
+	}
+	dirtySegments.Add(first, last + 1);
+	segmentTreeDirty.Add(first, last + 1);
+}
+
+void Spline::AddControlPoint(const glm::vec3 &position)
+{
+	float width = controlWidths.empty() ? 1.0f : controlWidths.back();
+	if (type == SPLINE_BEZIER && !controlPoints.empty())
+	{
+		// Place the tangent handles on the line towards the new end point
+		glm::vec3 last = controlPoints.back();
+		controlPoints.push_back(last + (position - last) / 3.0f);
+		controlPoints.push_back(last + (position - last) * 2.0f / 3.0f);
+		controlPointGrid.Add(controlPoints[controlPoints.size() - 2]);
+		controlPointGrid.Add(controlPoints.back());
+	}
+	controlPoints.push_back(position);
+	controlPointGrid.Add(position);
+	controlWidths.resize(controlPoints.size(), width);
+
+	int oldCount = static_cast<int>(segments.size());
+	int newCount = GetSegmentCount();
+	segments.resize(newCount);
+	segmentPoints.resize(4 * newCount);
+	arcLengths.resize(ARC_LENGTH_SAMPLES * newCount);
+	arcLengthTable.resize(4 * newCount);
+	for (int i = oldCount; i < newCount; i++)
+	{
+		RebuildSegment(i);
+	}
+	dirtySegments.Add(oldCount, newCount);
+	segmentTreeDirty.Add(oldCount, newCount);
+}
+
+void Spline::SetControlWidth(int index, float width)
+{
+	controlWidths[index] = width;
+
+	int first, last;
+	GetSegmentsOfPoint(index, first, last);
+	for (int i = first; i <= last; i++)
+	{
+		RebuildSegment(i);
+	}
+	dirtySegments.Add(first, last + 1);
+}
+
+float Spline::GetControlWidth(int index) const
+{
+	return controlWidths[index];
+}
+
+int Spline::FindControlPoint(const glm::vec3 &position, float radius) const
+{
+	return controlPointGrid.FindNearest(position, radius);
+}
+
+int Spline::GetSegmentCount() const
+{
+	int count = static_cast<int>(controlPoints.size());
+	if (count < 4)
+		return 0;
+
+	return type == SPLINE_BEZIER ? (count - 1) / 3 : count - 3;
+}
+
+const BezierCurve& Spline::GetSegment(int index) const
+{
+	return segments[index];
+}
+
+const std::vector<glm::vec4>& Spline::GetSegmentPoints() const
+{
+	return segmentPoints;
+}
+
+void Spline::EvaluateWidth(int segment, const float *t, unsigned int count, float *widths) const
+{
+	const glm::vec4 *b = &segmentPoints[4 * segment];
+	for (unsigned int i = 0; i < count; i++)
+	{
+		float s = 1.0f - t[i];
+		widths[i] = s * s * s * b[0].w + 3.0f * s * s * t[i] * b[1].w + 3.0f * s * t[i] * t[i] * b[2].w + t[i] * t[i] * t[i] * b[3].w;
+	}
+}
+
+void Spline::Evaluate(const float *t, unsigned int count, glm::vec3 *points,
+						glm::vec3 *tangents, glm::vec3 *normals) const
+{
+	int segmentCount = GetSegmentCount();
+	if (segmentCount == 0)
+		return;
+
+	// Split the global parameter in segment index and local parameter
+	localParameters.resize(count);
+	unsigned int i = 0;
+	while (i < count)
+	{
+		int segment = glm::clamp(static_cast<int>(t[i] * segmentCount), 0, segmentCount - 1);
+
+		// Gather the run of parameters that fall on the same segment
+		unsigned int end = i;
+		while (end < count)
+		{
+			float u = t[end] * segmentCount;
+			if (glm::clamp(static_cast<int>(u), 0, segmentCount - 1) != segment)
+				break;
+			localParameters[end] = u - segment;
+			end++;
+		}
+
+		segments[segment].Evaluate(&localParameters[i], end - i, points + i,
+									tangents ? tangents + i : nullptr, normals ? normals + i : nullptr);
+
+		// Local tangents are relative to the segment parameter
+		if (tangents)
+		{
+			for (unsigned int k = i; k < end; k++)
+				tangents[k] *= float(segmentCount);
+		}
+		i = end;
+	}
+}
+
+NearestPoint Spline::FindNearestPoint(const glm::vec3 &position, float maxDistance) const
+{
+	if (!segmentTreeDirty.IsEmpty() || segmentTree.GetSegmentCount() != GetSegmentCount())
+	{
+		segmentTree.Refit(segmentPoints, segmentTreeDirty.begin, segmentTreeDirty.end);
+		segmentTreeDirty.Clear();
+	}
+	return segmentTree.FindNearest(segmentPoints, position, maxDistance);
+}
+
+float Spline::GetLength() const
+{
+	UpdateSegmentOffsets();
+	return segmentOffsets.back();
+}
+
+float Spline::GetSegmentLength(int segment) const
+{
+	return arcLengths[ARC_LENGTH_SAMPLES * (segment + 1) - 1];
+}
+
+float Spline::GetSegmentLengthFraction(int segment, float t) const
+{
+	const glm::vec4 *table = &arcLengthTable[4 * segment];
+
+	// Linear interpolation between the 2 samples around t, the table starts at t = 1 / ARC_LENGTH_SAMPLES
+	float x = glm::clamp(t, 0.0f, 1.0f) * ARC_LENGTH_SAMPLES;
+	int i = std::min(static_cast<int>(x), ARC_LENGTH_SAMPLES - 1);
+	float s0 = i == 0 ? 0.0f : table[(i - 1) / 4][(i - 1) % 4];
+	float s1 = table[i / 4][i % 4];
+	return s0 + (s1 - s0) * (x - i);
+}
+
+float Spline::GetParameterAtLength(float length) const
+{
+	int segmentCount = GetSegmentCount();
+	if (segmentCount == 0)
+		return 0.0f;
+
+	UpdateSegmentOffsets();
+	if (length <= 0.0f)
+		return 0.0f;
+	if (length >= segmentOffsets.back())
+		return 1.0f;
+
+	// Segment that contains the length, then the samples around it
+	int segment = static_cast<int>(std::upper_bound(segmentOffsets.begin(), segmentOffsets.end(), length) - segmentOffsets.begin()) - 1;
+	segment = glm::clamp(segment, 0, segmentCount - 1);
+	float local = length - segmentOffsets[segment];
+
+	const float *samples = &arcLengths[ARC_LENGTH_SAMPLES * segment];
+	int i = static_cast<int>(std::lower_bound(samples, samples + ARC_LENGTH_SAMPLES, local) - samples);
+	i = std::min(i, ARC_LENGTH_SAMPLES - 1);
+
+	float s0 = i == 0 ? 0.0f : samples[i - 1];
+	float s1 = samples[i];
+	float fraction = s1 > s0 ? (local - s0) / (s1 - s0) : 0.0f;
+
+	float t = (i + fraction) / ARC_LENGTH_SAMPLES;
+	return (segment + t) / segmentCount;
+}
+
+const std::vector<glm::vec4>& Spline::GetArcLengthTable() const
+{
+	return arcLengthTable;
+}
+
+bool Spline::IsDirty() const
+{
+	return !dirtySegments.IsEmpty();
+}
+
+int Spline::GetFirstDirtySegment() const
+{
+	return dirtySegments.begin;
+}
+
+int Spline::GetDirtySegmentsCount() const
+{
+	return dirtySegments.end - dirtySegments.begin;
+}
+
+void Spline::ClearDirty()
+{
+	dirtySegments.Clear();
+}
+
+int Spline::GetFirstPointOfSegment(int segment) const
+{
+	return type == SPLINE_BEZIER ? 3 * segment : segment;
+}
+
+void Spline::GetSegmentsOfPoint(int index, int &first, int &last) const
+{
+	if (type == SPLINE_BEZIER)
+	{
+		// End points are shared by 2 segments, the tangent handles belong to one
+		first = (index % 3 == 0) ? index / 3 - 1 : index / 3;
+		last = index / 3;
+	}
+	else
+	{
+		// Segment i uses the points i .. i + 3
+		first = index - 3;
+		last = index;
+	}
+
+	first = std::max(first, 0);
+	last = std::min(last, GetSegmentCount() - 1);
+}
+
+void Spline::Rebuild()
+{
+	int segmentCount = GetSegmentCount();
+	segments.resize(segmentCount);
+	segmentPoints.resize(4 * segmentCount);
+	arcLengths.resize(ARC_LENGTH_SAMPLES * segmentCount);
+	arcLengthTable.resize(4 * segmentCount);
+	for (int i = 0; i < segmentCount; i++)
+	{
+		RebuildSegment(i);
+	}
+	segmentOffsetsValid = false;
+	dirtySegments.Add(0, segmentCount);
+	segmentTreeDirty.Add(0, segmentCount);
+}
+
+void Spline::RebuildSegment(int segment)
+{
+	// The width goes through the same basis as the position
+	int first = GetFirstPointOfSegment(segment);
+	glm::vec4 p[4];
+	for (int i = 0; i < 4; i++)
+		p[i] = glm::vec4(controlPoints[first + i], controlWidths[first + i]);
+
+	glm::vec4 bezier[4];
+
+	switch (type)
+	{
+	case SPLINE_BEZIER:
+		std::copy(p, p + 4, bezier);
+		break;
+
+	case SPLINE_CATMULL_ROM:
+		bezier[0] = p[1];
+		bezier[1] = p[1] + (p[2] - p[0]) / 6.0f;
+		bezier[2] = p[2] - (p[3] - p[1]) / 6.0f;
+		bezier[3] = p[2];
+		break;
+
+	case SPLINE_BSPLINE:
+		bezier[0] = (p[0] + 4.0f * p[1] + p[2]) / 6.0f;
+		bezier[1] = (2.0f * p[1] + p[2]) / 3.0f;
+		bezier[2] = (p[1] + 2.0f * p[2]) / 3.0f;
+		bezier[3] = (p[1] + 4.0f * p[2] + p[3]) / 6.0f;
+		break;
+
+	default:
+		break;
+	}
+
+	BezierCurve &curve = segments[segment];
+	if (curve.GetControlPointsCount() != 4)
+	{
+		curve.SetControlPoints(std::vector<glm::vec3>(4));
+	}
+
+	for (int i = 0; i < 4; i++)
+	{
+		curve.SetControlPoint(i, glm::vec3(bezier[i]));
+		segmentPoints[4 * segment + i] = bezier[i];
+	}
+
+	RebuildArcLength(segment);
+}
+
+void Spline::RebuildArcLength(int segment)
+{
+	// Each sample of the table is measured on a finer polyline
+	const int subdivisions = 4;
+	const int pointsCount = ARC_LENGTH_SAMPLES * subdivisions + 1;
+
+	arcParameters.resize(pointsCount);
+	arcPoints.resize(pointsCount);
+	for (int i = 0; i < pointsCount; i++)
+		arcParameters[i] = i / float(pointsCount - 1);
+
+	segments[segment].Evaluate(arcParameters.data(), pointsCount, arcPoints.data());
+
+	float *samples = &arcLengths[ARC_LENGTH_SAMPLES * segment];
+	float length = 0.0f;
+	for (int i = 1; i < pointsCount; i++)
+	{
+		length += glm::length(arcPoints[i] - arcPoints[i - 1]);
+		if (i % subdivisions == 0)
+			samples[i / subdivisions - 1] = length;
+	}
+
+	// Normalized copy for the shaders, a degenerate segment falls back to its parameter
+	glm::vec4 *table = &arcLengthTable[4 * segment];
+	for (int i = 0; i < ARC_LENGTH_SAMPLES; i++)
+		table[i / 4][i % 4] = length > 0.0f ? samples[i] / length : (i + 1) / float(ARC_LENGTH_SAMPLES);
+
+	segmentOffsetsValid = false;
+}
+
+void Spline::UpdateSegmentOffsets() const
+{
+	if (segmentOffsetsValid)
+		return;
+
+	int segmentCount = GetSegmentCount();
+	segmentOffsets.resize(segmentCount + 1);
+	segmentOffsets[0] = 0.0f;
+	for (int i = 0; i < segmentCount; i++)
+		segmentOffsets[i + 1] = segmentOffsets[i] + GetSegmentLength(i);
+
+	segmentOffsetsValid = true;
+}
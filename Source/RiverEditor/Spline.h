@@ -0,0 +1,165 @@
+#pragma once
+
+#include <vector>
+
+#include <include/glm.h>
+
+#include "BezierCurve.h"
+#include "PointGrid.h"
+#include "SegmentBVH.h"
+
+enum SplineType
+{
+	// Every 3 points after the first one describe a new cubic segment
+	SPLINE_BEZIER,
+	// Interpolates the inner control points, one segment for each 4 consecutive points
+	SPLINE_CATMULL_ROM,
+	// Uniform cubic B-spline, one segment for each 4 consecutive points
+	SPLINE_BSPLINE,
+	SPLINE_TYPES_COUNT
+};
+
+// Half open range [begin, end) of segments waiting to be rebuilt
+struct SegmentRange
+{
+	SegmentRange() : begin(0), end(0) {}
+
+	bool IsEmpty() const { return end <= begin; }
+	void Clear() { begin = end = 0; }
+
+	// Extends the range so it also covers [first, last)
+	void Add(int first, int last)
+	{
+		if (last <= first)
+			return;
+
+		if (IsEmpty())
+		{
+			begin = first;
+			end = last;
+			return;
+		}
+
+		begin = first < begin ? first : begin;
+		end = last > end ? last : end;
+	}
+
+	int begin;
+	int end;
+};
+
+// Piecewise cubic curve, each segment is converted to its Bezier form.
+// Every control point also has a width factor, converted the same way as the position,
+// so the width profile is a cubic of its own that follows the segments of the curve.
+// Edits keep track of the range of segments that changed since the last ClearDirty().
+class Spline
+{
+public:
+	Spline();
+
+	void SetType(SplineType type);
+	SplineType GetType() const;
+	static const char* GetTypeName(SplineType type);
+
+	void SetControlPoints(const std::vector<glm::vec3> &controlPoints);
+	const std::vector<glm::vec3>& GetControlPoints() const;
+	int GetControlPointsCount() const;
+
+	// Moves a single point, only the 1-4 segments that use it are rebuilt
+	void MoveControlPoint(int index, const glm::vec3 &position);
+
+	// Extends the spline with a new segment ending at position, the new points keep the last width
+	void AddControlPoint(const glm::vec3 &position);
+
+	// Width factors of the control points, 1 after SetControlPoints()
+	// Changing one only rebuilds the segments that use the point, like MoveControlPoint
+	void SetControlWidth(int index, float width);
+	float GetControlWidth(int index) const;
+
+	// Nearest control point closer than radius, -1 if there is none
+	int FindControlPoint(const glm::vec3 &position, float radius) const;
+
+	int GetSegmentCount() const;
+	const BezierCurve& GetSegment(int index) const;
+
+	// Bezier control points of all segments, 4 consecutive points for each one
+	// The w component holds the Bezier form of the width profile
+	const std::vector<glm::vec4>& GetSegmentPoints() const;
+
+	// Width factor of the segment for each parameter
+	void EvaluateWidth(int segment, const float *t, unsigned int count, float *widths) const;
+
+	// Evaluates the whole spline, t is in [0, 1] from the first to the last segment
+	// Sorted parameters are evaluated in batches, one for each segment
+	void Evaluate(const float *t, unsigned int count, glm::vec3 *points,
+					glm::vec3 *tangents = nullptr, glm::vec3 *normals = nullptr) const;
+
+	// Closest point of the curve closer than maxDistance, the segment tree is refitted after edits
+	NearestPoint FindNearestPoint(const glm::vec3 &position, float maxDistance) const;
+
+	// Arc length, the table of a segment is rebuilt together with its Bezier points
+	float GetLength() const;
+	float GetSegmentLength(int segment) const;
+
+	// Fraction of the segment length covered from its start up to the local parameter t
+	float GetSegmentLengthFraction(int segment, float t) const;
+
+	// Inverse lookup, global parameter in [0, 1] of the point at the given distance from the start
+	float GetParameterAtLength(float length) const;
+
+	// Normalized arc length table for the GPU, 4 vec4 for each segment, same layout as GetSegmentPoints()
+	// Entry i holds the fraction of the length at t = (i + 1) / ARC_LENGTH_SAMPLES
+	const std::vector<glm::vec4>& GetArcLengthTable() const;
+
+	static const int ARC_LENGTH_SAMPLES = 16;
+
+	// Range of segments modified since the last ClearDirty()
+	bool IsDirty() const;
+	int GetFirstDirtySegment() const;
+	int GetDirtySegmentsCount() const;
+	void ClearDirty();
+
+private:
+	// Control points used by a segment
+	int GetFirstPointOfSegment(int segment) const;
+
+	// Range of segments that depend on a control point
+	void GetSegmentsOfPoint(int index, int &first, int &last) const;
+
+	void Rebuild();
+	void RebuildSegment(int segment);
+	void RebuildArcLength(int segment);
+
+	// Prefix sums of the segment lengths, updated on demand after edits
+	void UpdateSegmentOffsets() const;
+
+private:
+	SplineType type;
+	std::vector<glm::vec3> controlPoints;
+	std::vector<float> controlWidths;
+
+	// Spatial index of the control points, kept in sync by every edit
+	PointGrid controlPointGrid;
+
+	std::vector<BezierCurve> segments;
+	std::vector<glm::vec4> segmentPoints;
+
+	SegmentRange dirtySegments;
+
+	// ARC_LENGTH_SAMPLES lengths for each segment, measured from the segment start
+	std::vector<float> arcLengths;
+	std::vector<glm::vec4> arcLengthTable;
+
+	// Bounding volumes of the segments, refitted on demand for the ones changed since the last query
+	mutable SegmentBVH segmentTree;
+	mutable SegmentRange segmentTreeDirty;
+
+	// Length before each segment, the last entry is the total length
+	mutable std::vector<float> segmentOffsets;
+	mutable bool segmentOffsetsValid;
+
+	// Scratch memory for the batched evaluation
+	mutable std::vector<float> localParameters;
+	std::vector<float> arcParameters;
+	std::vector<glm::vec3> arcPoints;
+};
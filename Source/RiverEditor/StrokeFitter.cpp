@@ -0,0 +1,261 @@
+#include "StrokeFitter.h"
+
+#include <algorithm>
+
+namespace
+{
+	// Reparameterization steps tried when the first fit is close to the tolerance
+	const int MAX_ITERATIONS = 4;
+
+	glm::vec3 BezierPoint(const glm::vec3 b[4], float t)
+	{
+		float s = 1.0f - t;
+		return s * s * s * b[0] + 3.0f * s * s * t * b[1] + 3.0f * s * t * t * b[2] + t * t * t * b[3];
+	}
+
+	glm::vec3 BezierDerivative(const glm::vec3 b[4], float t)
+	{
+		float s = 1.0f - t;
+		return 3.0f * (s * s * (b[1] - b[0]) + 2.0f * s * t * (b[2] - b[1]) + t * t * (b[3] - b[2]));
+	}
+
+	glm::vec3 BezierSecondDerivative(const glm::vec3 b[4], float t)
+	{
+		return 6.0f * ((1.0f - t) * (b[2] - 2.0f * b[1] + b[0]) + t * (b[3] - 2.0f * b[2] + b[1]));
+	}
+
+	glm::vec3 Direction(const glm::vec3 &v, const glm::vec3 &fallback)
+	{
+		float length = glm::length(v);
+		return length > 1e-6f ? v / length : fallback;
+	}
+}
+
+StrokeFitter::StrokeFitter()
+{
+	tolerance = 0.05f;
+	minSampleDistance = 0.0f;
+	active = false;
+	firstChangedPoint = 0;
+	tailStart = 0;
+}
+
+void StrokeFitter::SetTolerance(float tolerance)
+{
+	this->tolerance = tolerance;
+}
+
+float StrokeFitter::GetTolerance() const
+{
+	return tolerance;
+}
+
+void StrokeFitter::SetMinSampleDistance(float distance)
+{
+	minSampleDistance = distance;
+}
+
+void StrokeFitter::Begin(const glm::vec3 &point)
+{
+	samples.assign(1, point);
+	sampleLengths.assign(1, 0.0f);
+	controlPoints.assign(1, point);
+	firstChangedPoint = 0;
+	tailStart = 0;
+	active = true;
+}
+
+bool StrokeFitter::AddSample(const glm::vec3 &point)
+{
+	if (!active)
+		return false;
+
+	float distance = glm::distance(point, samples.back());
+	if (distance <= minSampleDistance || distance < 1e-6f)
+		return false;
+
+	samples.push_back(point);
+	sampleLengths.push_back(sampleLengths.back() + distance);
+
+	int last = static_cast<int>(samples.size()) - 1;
+	glm::vec3 bezier[4];
+
+	// The first segment, 2 samples are always fitted exactly
+	if (controlPoints.size() < 4)
+	{
+		controlPoints.resize(4);
+		FitTail(bezier);
+		SetTail(bezier);
+		return true;
+	}
+
+	if (last - tailStart < MAX_TAIL_SAMPLES && FitTail(bezier) <= tolerance * tolerance)
+	{
+		SetTail(bezier);
+		return true;
+	}
+
+	// The previous fit of the tail is kept, a new tail starts from the last sample it covered
+	tailStart = last - 1;
+	controlPoints.resize(controlPoints.size() + 3);
+	FitTail(bezier);
+	SetTail(bezier);
+	return true;
+}
+
+void StrokeFitter::End()
+{
+	active = false;
+}
+
+bool StrokeFitter::IsActive() const
+{
+	return active;
+}
+
+const std::vector<glm::vec3>& StrokeFitter::GetControlPoints() const
+{
+	return controlPoints;
+}
+
+int StrokeFitter::GetFirstChangedPoint() const
+{
+	return firstChangedPoint;
+}
+
+void StrokeFitter::ClearChanged()
+{
+	firstChangedPoint = static_cast<int>(controlPoints.size());
+}
+
+int StrokeFitter::GetSamplesCount() const
+{
+	return static_cast<int>(samples.size());
+}
+
+float StrokeFitter::FitTail(glm::vec3 bezier[4])
+{
+	int first = tailStart;
+	int last = static_cast<int>(samples.size()) - 1;
+
+	glm::vec3 leftTangent = GetLeftTangent();
+	glm::vec3 rightTangent = GetRightTangent();
+
+	// Chord length parameterization
+	float length = sampleLengths[last] - sampleLengths[first];
+	parameters.resize(last - first + 1);
+	for (int i = first; i <= last; i++)
+		parameters[i - first] = (sampleLengths[i] - sampleLengths[first]) / length;
+
+	float error = FitCubic(first, last, leftTangent, rightTangent, bezier);
+	if (error <= tolerance * tolerance || error > 4.0f * tolerance * tolerance)
+		return error;
+
+	// Close enough, move the parameters towards the curve and try again
+	for (int i = 0; i < MAX_ITERATIONS && error > tolerance * tolerance; i++)
+	{
+		Reparameterize(first, last, bezier);
+		error = FitCubic(first, last, leftTangent, rightTangent, bezier);
+	}
+	return error;
+}
+
+float StrokeFitter::FitCubic(int first, int last, const glm::vec3 &leftTangent, const glm::vec3 &rightTangent, glm::vec3 bezier[4])
+{
+	const glm::vec3 &p0 = samples[first];
+	const glm::vec3 &p3 = samples[last];
+
+	// Normal equations for the lengths of the 2 tangent handles
+	float c00 = 0.0f, c01 = 0.0f, c11 = 0.0f;
+	float x0 = 0.0f, x1 = 0.0f;
+	for (int i = first; i <= last; i++)
+	{
+		float t = parameters[i - first];
+		float s = 1.0f - t;
+		float b0 = s * s * s, b1 = 3.0f * s * s * t, b2 = 3.0f * s * t * t, b3 = t * t * t;
+
+		glm::vec3 a1 = leftTangent * b1;
+		glm::vec3 a2 = rightTangent * b2;
+		glm::vec3 rest = samples[i] - (p0 * (b0 + b1) + p3 * (b2 + b3));
+
+		c00 += glm::dot(a1, a1);
+		c01 += glm::dot(a1, a2);
+		c11 += glm::dot(a2, a2);
+		x0 += glm::dot(a1, rest);
+		x1 += glm::dot(a2, rest);
+	}
+
+	float alphaLeft = 0.0f, alphaRight = 0.0f;
+	float determinant = c00 * c11 - c01 * c01;
+	if (fabs(determinant) > 1e-12f)
+	{
+		alphaLeft = (x0 * c11 - x1 * c01) / determinant;
+		alphaRight = (c00 * x1 - c01 * x0) / determinant;
+	}
+
+	// Degenerate or flipped handles fall back to a third of the chord
+	float chord = glm::distance(p0, p3);
+	float epsilon = 1e-6f * chord;
+	if (alphaLeft < epsilon || alphaRight < epsilon)
+		alphaLeft = alphaRight = chord / 3.0f;
+
+	bezier[0] = p0;
+	bezier[1] = p0 + leftTangent * alphaLeft;
+	bezier[2] = p3 + rightTangent * alphaRight;
+	bezier[3] = p3;
+
+	float error = 0.0f;
+	for (int i = first + 1; i < last; i++)
+	{
+		glm::vec3 difference = BezierPoint(bezier, parameters[i - first]) - samples[i];
+		error = std::max(error, glm::dot(difference, difference));
+	}
+	return error;
+}
+
+void StrokeFitter::Reparameterize(int first, int last, const glm::vec3 bezier[4])
+{
+	for (int i = first + 1; i < last; i++)
+	{
+		float &t = parameters[i - first];
+		glm::vec3 difference = BezierPoint(bezier, t) - samples[i];
+		glm::vec3 derivative = BezierDerivative(bezier, t);
+
+		float denominator = glm::dot(derivative, derivative) + glm::dot(difference, BezierSecondDerivative(bezier, t));
+		if (fabs(denominator) > 1e-12f)
+			t = glm::clamp(t - glm::dot(difference, derivative) / denominator, 0.0f, 1.0f);
+	}
+}
+
+glm::vec3 StrokeFitter::GetLeftTangent() const
+{
+	int last = static_cast<int>(samples.size()) - 1;
+	glm::vec3 chord = Direction(samples[last] - samples[tailStart], glm::vec3(1.0f, 0.0f, 0.0f));
+
+	// Continue the previous segment so the joint is smooth
+	size_t count = controlPoints.size();
+	if (count >= 7)
+	{
+		glm::vec3 handle = controlPoints[count - 4] - controlPoints[count - 5];
+		if (glm::length(handle) > 1e-6f)
+			return glm::normalize(handle);
+	}
+
+	return Direction(samples[std::min(tailStart + 2, last)] - samples[tailStart], chord);
+}
+
+glm::vec3 StrokeFitter::GetRightTangent() const
+{
+	int last = static_cast<int>(samples.size()) - 1;
+	glm::vec3 chord = Direction(samples[tailStart] - samples[last], glm::vec3(-1.0f, 0.0f, 0.0f));
+	return Direction(samples[std::max(last - 2, tailStart)] - samples[last], chord);
+}
+
+void StrokeFitter::SetTail(const glm::vec3 bezier[4])
+{
+	int first = static_cast<int>(controlPoints.size()) - 3;
+	for (int i = 0; i < 3; i++)
+		controlPoints[first + i] = bezier[i + 1];
+
+	firstChangedPoint = std::min(firstChangedPoint, first);
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <vector>
+
+#include <include/glm.h>
+
+// Fits a freehand stroke with a piecewise cubic Bezier curve while it is being drawn.
+// Each new sample only refits the last (tail) segment with Schneider's least squares method,
+// the tangent at its start is fixed by the previous segment so the curve stays smooth.
+// When the tail can't follow the samples within tolerance anymore, its last good fit is
+// committed and a new tail starts from the last sample it covered.
+class StrokeFitter
+{
+public:
+	StrokeFitter();
+
+	// Maximum distance between the samples and the curve
+	void SetTolerance(float tolerance);
+	float GetTolerance() const;
+
+	// Samples closer than this to the previous one are ignored
+	void SetMinSampleDistance(float distance);
+
+	void Begin(const glm::vec3 &point);
+
+	// Returns false if the sample was ignored and the curve didn't change
+	bool AddSample(const glm::vec3 &point);
+
+	void End();
+	bool IsActive() const;
+
+	// Same layout as SPLINE_BEZIER, every 3 points after the first one describe a segment
+	const std::vector<glm::vec3>& GetControlPoints() const;
+
+	// Control points changed since the last ClearChanged(), new points included
+	int GetFirstChangedPoint() const;
+	void ClearChanged();
+
+	int GetSamplesCount() const;
+
+	// Upper bound of the samples refitted by AddSample
+	static const int MAX_TAIL_SAMPLES = 256;
+
+private:
+	// Least squares cubic through the tail samples, returns the largest squared distance
+	float FitTail(glm::vec3 bezier[4]);
+
+	// Single fit for the current parameters and tangents, returns the largest squared distance
+	float FitCubic(int first, int last, const glm::vec3 &leftTangent, const glm::vec3 &rightTangent, glm::vec3 bezier[4]);
+
+	// One Newton-Raphson step for every parameter towards the closest point of the curve
+	void Reparameterize(int first, int last, const glm::vec3 bezier[4]);
+
+	// Directions estimated from the samples, both point inside the tail
+	glm::vec3 GetLeftTangent() const;
+	glm::vec3 GetRightTangent() const;
+
+	// Writes the tail segment in the control points
+	void SetTail(const glm::vec3 bezier[4]);
+
+private:
+	float tolerance;
+	float minSampleDistance;
+	bool active;
+
+	std::vector<glm::vec3> samples;
+
+	// Distance along the polyline up to each sample, for the chord length parameterization
+	std::vector<float> sampleLengths;
+
+	std::vector<glm::vec3> controlPoints;
+	int firstChangedPoint;
+
+	// First sample of the tail segment
+	int tailStart;
+
+	// Parameters of the tail samples, scratch memory
+	std::vector<float> parameters;
+};
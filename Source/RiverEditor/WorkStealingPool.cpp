@@ -0,0 +1,130 @@
+#include "WorkStealingPool.h"
+
+#include <algorithm>
+
+WorkStealingPool::WorkStealingPool(unsigned int workersCount)
+{
+	if (workersCount == 0)
+		workersCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+	task = nullptr;
+	remainingTasks = 0;
+	generation = 0;
+	stopping = false;
+
+	for (unsigned int i = 0; i < workersCount; i++)
+		queues.push_back(std::unique_ptr<Queue>(new Queue()));
+
+	// Worker 0 is the thread that calls ParallelFor()
+	for (unsigned int i = 1; i < workersCount; i++)
+		threads.push_back(std::thread(&WorkStealingPool::WorkerLoop, this, i));
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(wakeMutex);
+		stopping = true;
+	}
+	wakeCondition.notify_all();
+
+	for (auto &thread : threads)
+		thread.join();
+}
+
+int WorkStealingPool::GetWorkersCount() const
+{
+	return static_cast<int>(queues.size());
+}
+
+void WorkStealingPool::ParallelFor(int count, const std::function<void(int index, int worker)> &task)
+{
+	if (count <= 0)
+		return;
+
+	this->task = &task;
+	remainingTasks = count;
+
+	// Contiguous blocks keep neighbouring tasks on the same thread, stealing evens out the rest
+	int workers = GetWorkersCount();
+	for (int worker = 0; worker < workers; worker++)
+	{
+		int first = static_cast<int>(static_cast<long long>(count) * worker / workers);
+		int last = static_cast<int>(static_cast<long long>(count) * (worker + 1) / workers);
+
+		std::lock_guard<std::mutex> lock(queues[worker]->mutex);
+		for (int i = first; i < last; i++)
+			queues[worker]->indices.push_back(i);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(wakeMutex);
+		generation++;
+	}
+	wakeCondition.notify_all();
+
+	while (remainingTasks > 0)
+	{
+		if (!RunTask(0))
+			std::this_thread::yield();
+	}
+
+	this->task = nullptr;
+}
+
+void WorkStealingPool::WorkerLoop(int worker)
+{
+	unsigned int seenGeneration = 0;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(wakeMutex);
+			wakeCondition.wait(lock, [&] { return stopping || generation != seenGeneration; });
+			if (stopping)
+				return;
+			seenGeneration = generation;
+		}
+
+		while (remainingTasks > 0)
+		{
+			if (!RunTask(worker))
+				std::this_thread::yield();
+		}
+	}
+}
+
+bool WorkStealingPool::RunTask(int worker)
+{
+	int index = -1;
+	int workers = GetWorkersCount();
+
+	// Own queue first, newest task
+	{
+		Queue &queue = *queues[worker];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (!queue.indices.empty())
+		{
+			index = queue.indices.back();
+			queue.indices.pop_back();
+		}
+	}
+
+	// Steal the oldest task of another worker
+	for (int i = 1; i < workers && index == -1; i++)
+	{
+		Queue &queue = *queues[(worker + i) % workers];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (!queue.indices.empty())
+		{
+			index = queue.indices.front();
+			queue.indices.pop_front();
+		}
+	}
+
+	if (index == -1)
+		return false;
+
+	(*task)(index, worker);
+	remainingTasks--;
+	return true;
+}
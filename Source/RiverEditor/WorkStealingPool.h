@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <functional>
+#include <condition_variable>
+
+// Fixed set of worker threads, each with its own queue of task indices.
+// A worker takes its own tasks from the back and steals from the front of the
+// other queues once it runs out, so uneven tasks still keep every core busy.
+// The thread calling ParallelFor() works as worker 0 until the whole range is done.
+class WorkStealingPool
+{
+public:
+	// 0 uses one worker for each hardware thread
+	explicit WorkStealingPool(unsigned int workersCount = 0);
+	~WorkStealingPool();
+
+	// Number of workers, including the calling thread
+	int GetWorkersCount() const;
+
+	// Runs task(index, worker) for every index in [0, count) and waits for all of them
+	// The worker index is in [0, GetWorkersCount()), use it to pick per thread scratch memory
+	void ParallelFor(int count, const std::function<void(int index, int worker)> &task);
+
+private:
+	struct Queue
+	{
+		std::mutex mutex;
+		std::deque<int> indices;
+	};
+
+	void WorkerLoop(int worker);
+
+	// Runs a single task, from the own queue or stolen, returns false if every queue was empty
+	bool RunTask(int worker);
+
+private:
+	std::vector<std::thread> threads;
+	std::vector<std::unique_ptr<Queue>> queues;
+
+	const std::function<void(int, int)> *task;
+	std::atomic<int> remainingTasks;
+
+	// Workers sleep until the generation changes
+	std::mutex wakeMutex;
+	std::condition_variable wakeCondition;
+	unsigned int generation;
+	bool stopping;
+};